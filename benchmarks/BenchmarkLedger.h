@@ -0,0 +1,40 @@
+#ifndef BENCHMARKLEDGER_H
+#define BENCHMARKLEDGER_H
+
+#include "../models/User.h"
+#include "../models/Record.h"
+#include "../models/Category.h"
+#include <QDateTime>
+#include <memory>
+
+// 基准测试用账本：每天固定条数，分类、收支类型和金额由固定种子的伪随机数决定
+inline std::shared_ptr<User> buildBenchmarkLedger(const QDate& first, const QDate& last,
+                                                  int recordsPerDay, int categoryCount) {
+    auto user = std::make_shared<User>("benchmark", "Benchmark User");
+    QVector<std::shared_ptr<Category>> categories;
+    for (int i = 0; i < categoryCount; ++i) {
+        auto category = Category::create();
+        category->setName(QString("分类%1").arg(i));
+        user->addCategory(category);
+        categories.append(category);
+    }
+
+    QVector<std::shared_ptr<Record>> records;
+    records.reserve(int(first.daysTo(last) + 1) * recordsPerDay);
+    quint32 seed = 12345;
+    for (QDate day = first; day <= last; day = day.addDays(1)) {
+        for (int i = 0; i < recordsPerDay; ++i) {
+            seed = seed * 1103515245u + 12345u;
+            auto record = Record::create();
+            record->setCategoryId(categories[seed % categoryCount]->getId());
+            record->setType(seed % 10 == 0 ? Record::Type::Income : Record::Type::Expense);
+            record->setAmount(1.0 + (seed >> 8) % 50000 / 100.0);
+            record->setDateTime(QDateTime(day, QTime(8 + i % 12, i % 60)));
+            records.append(record);
+        }
+    }
+    user->addRecords(records);
+    return user;
+}
+
+#endif // BENCHMARKLEDGER_H
@@ -0,0 +1,65 @@
+#include "BenchmarkLedger.h"
+#include "../services/LedgerAggregator.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstdio>
+
+// 并行聚合基准：约200万条、跨度10年的账本，比较1~16个线程在全范围和最近一年上的聚合耗时
+// 加速比受限于可用核心数，结果须结合输出中的 hardware threads 解读
+
+namespace {
+
+const int kYears = 10;
+const int kRecordsPerDay = 550;
+const int kCategoryCount = 20;
+const int kRepeats = 5;
+
+void runCase(const char* name, const LedgerSnapshot& snapshot, const QDate& start, const QDate& end,
+             QThreadPool* pool) {
+    std::printf("%s (%d records)\n", name, snapshot.countInRange(start, end));
+    QElapsedTimer timer;
+    double baseline = 0.0;
+    for (int workers : {1, 2, 4, 8, 16}) {
+        // 取多次运行中的最短耗时
+        double best = -1.0;
+        double checksum = 0.0;
+        for (int i = 0; i < kRepeats; ++i) {
+            timer.start();
+            auto result = LedgerAggregator::aggregate(snapshot, start, end, pool, workers);
+            double elapsed = timer.nsecsElapsed() / 1e6;
+            best = best < 0.0 ? elapsed : std::min(best, elapsed);
+            checksum = result.totalExpense - result.totalIncome;
+        }
+        if (workers == 1) {
+            baseline = best;
+        }
+        std::printf("  workers: %2d  time: %8.2f ms  speedup: %5.2fx  checksum: %.2f\n",
+                    workers, best, baseline / best, checksum);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QDate last(2024, 12, 31);
+    QDate first = last.addYears(-kYears).addDays(1);
+    QElapsedTimer timer;
+    timer.start();
+    auto user = buildBenchmarkLedger(first, last, kRecordsPerDay, kCategoryCount);
+    auto snapshot = user->snapshot();
+    std::printf("records: %d, chunks: %d, build: %lld ms, hardware threads: %d\n",
+                snapshot->rowCount(), int(snapshot->chunks().size()), static_cast<long long>(timer.elapsed()),
+                QThread::idealThreadCount());
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(16);
+    runCase("all records", *snapshot, first, last, &pool);
+    runCase("last year", *snapshot, last.addYears(-1).addDays(1), last, &pool);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "BenchmarkLedger.h"
+#include "../models/ColumnKernels.h"
+#include "../models/LedgerSnapshot.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cstdio>
+
+// 求和内核基准：比较原先逐条记录的累加循环、标量内核和运行时选择的内核
+// 分别在全部数据（约200万条）和最近30天上计算总收入
+
+namespace {
+
+const int kYears = 10;
+const int kRecordsPerDay = 550;
+const int kCategoryCount = 20;
+const int kRepeats = 10;
+
+// 多次运行取最短耗时（毫秒），result 保存最后一次的结果
+template <typename Function>
+double bestOf(Function run, double& result) {
+    QElapsedTimer timer;
+    double best = -1.0;
+    for (int i = 0; i < kRepeats; ++i) {
+        timer.start();
+        result = run();
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        best = best < 0.0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+double scalarTotal(const LedgerSnapshot& snapshot, const QDate& start, const QDate& end, quint8 kind) {
+    double total = 0.0;
+    qint64 startDay = start.toJulianDay();
+    qint64 endDay = end.toJulianDay();
+    for (const auto& chunk : snapshot.chunks()) {
+        int begin = 0;
+        int stop = 0;
+        chunk->rowRange(startDay, endDay, begin, stop);
+        total += ColumnKernels::sumWhereKindScalar(chunk->amounts.constData() + begin,
+                                                   chunk->kinds.constData() + begin, stop - begin, kind);
+    }
+    return total;
+}
+
+void runCase(const char* name, const User& user, const QDate& start, const QDate& end) {
+    auto snapshot = user.snapshot();
+    const quint8 income = static_cast<quint8>(Record::Type::Income);
+    double loopResult = 0.0;
+    double scalarResult = 0.0;
+    double kernelResult = 0.0;
+
+    double loop = bestOf([&]() {
+        double total = 0.0;
+        user.forEachRecordInRange(start, end, [&total](const Record& record) {
+            if (record.isIncome()) {
+                total += record.getAmount();
+            }
+        });
+        return total;
+    }, loopResult);
+    double scalar = bestOf([&]() { return scalarTotal(*snapshot, start, end, income); }, scalarResult);
+    double kernel = bestOf([&]() {
+        return snapshot->totalInRange(start, end, Record::Type::Income);
+    }, kernelResult);
+
+    std::printf("%s (%d records)\n", name, snapshot->countInRange(start, end));
+    std::printf("  record loop    %8.3f ms             total: %.2f\n", loop, loopResult);
+    std::printf("  scalar kernel  %8.3f ms  %6.2fx     total: %.2f\n", scalar, loop / scalar, scalarResult);
+    std::printf("  %-6s kernel  %8.3f ms  %6.2fx     total: %.2f\n",
+                ColumnKernels::implementationName(), kernel, loop / kernel, kernelResult);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QDate last(2024, 12, 31);
+    QDate first = last.addYears(-kYears).addDays(1);
+    auto user = buildBenchmarkLedger(first, last, kRecordsPerDay, kCategoryCount);
+
+    runCase("all records", *user, first, last);
+    runCase("last 30 days", *user, last.addDays(-29), last);
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "../models/Record.h"
+#include "../models/StringPool.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+// 记录字段基准：备注驻留与直接保存QString、UTC毫秒时间戳与直接保存QDateTime
+// 约20万条记录，备注从500种常见文本中选取
+
+namespace {
+
+const int kRecordCount = 200000;
+const int kDistinctNotes = 500;
+const int kRepeats = 5;
+
+// 改造前的记录字段布局，读取接口按值返回
+struct PlainRecord {
+    QString note;
+    QDateTime dateTime;
+
+    QString getNote() const { return note; }
+};
+
+template <typename Function>
+double bestOf(Function run, double& result) {
+    QElapsedTimer timer;
+    double best = -1.0;
+    for (int i = 0; i < kRepeats; ++i) {
+        timer.start();
+        result = run();
+        double elapsed = timer.nsecsElapsed() / 1e6;
+        best = best < 0.0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void printRow(const char* name, double plain, double pooled, double plainResult, double pooledResult) {
+    std::printf("  %-24s QString/QDateTime %8.3f ms   Record %8.3f ms  %6.2fx   check: %.0f / %.0f\n",
+                name, plain, pooled, plain / pooled, plainResult, pooledResult);
+}
+
+// 多个线程同时读取备注，衡量读取路径是否随线程数扩展
+double concurrentNoteReads(const QVector<Record>& records, int workers) {
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    std::atomic<qint64> total{0};
+    int perWorker = (records.size() + workers - 1) / workers;
+    QElapsedTimer timer;
+    timer.start();
+    for (int w = 0; w < workers; ++w) {
+        int begin = w * perWorker;
+        int end = std::min(int(records.size()), begin + perWorker);
+        pool.start([&records, &total, begin, end]() {
+            qint64 length = 0;
+            for (int i = begin; i < end; ++i) {
+                length += records[i].getNote().size();
+            }
+            total += length;
+        });
+    }
+    pool.waitForDone();
+    return timer.nsecsElapsed() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QStringList notes;
+    for (int i = 0; i < kDistinctNotes; ++i) {
+        notes.append(QString("午餐 便利店 第%1号备注").arg(i));
+    }
+    QDate first(2015, 1, 1);
+    QVector<QDateTime> times;
+    times.reserve(kRecordCount);
+    quint32 seed = 12345;
+    for (int i = 0; i < kRecordCount; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        times.append(QDateTime(first.addDays(seed % 3650), QTime(8 + i % 12, i % 60)));
+    }
+
+    QVector<PlainRecord> plain(kRecordCount);
+    QVector<Record> records(kRecordCount);
+    double plainResult = 0.0;
+    double pooledResult = 0.0;
+
+    std::printf("notes (%d records, %d distinct)\n", kRecordCount, kDistinctNotes);
+    double plainWrite = bestOf([&]() {
+        for (int i = 0; i < kRecordCount; ++i) {
+            plain[i].note = notes[i % kDistinctNotes];
+        }
+        return double(plain.size());
+    }, plainResult);
+    double pooledWrite = bestOf([&]() {
+        for (int i = 0; i < kRecordCount; ++i) {
+            records[i].setNote(notes[i % kDistinctNotes]);
+        }
+        return double(StringPool::notes().size());
+    }, pooledResult);
+    printRow("write", plainWrite, pooledWrite, plainResult, pooledResult);
+
+    double plainRead = bestOf([&]() {
+        qint64 length = 0;
+        for (const auto& record : plain) {
+            length += record.getNote().size();
+        }
+        return double(length);
+    }, plainResult);
+    double pooledRead = bestOf([&]() {
+        qint64 length = 0;
+        for (const auto& record : records) {
+            length += record.getNote().size();
+        }
+        return double(length);
+    }, pooledResult);
+    printRow("read", plainRead, pooledRead, plainResult, pooledResult);
+
+    double baseline = 0.0;
+    for (int workers : {1, 2, 4, 8}) {
+        double best = -1.0;
+        for (int i = 0; i < kRepeats; ++i) {
+            double elapsed = concurrentNoteReads(records, workers);
+            best = best < 0.0 ? elapsed : std::min(best, elapsed);
+        }
+        if (workers == 1) {
+            baseline = best;
+        }
+        std::printf("  read, %d threads          %8.3f ms  speedup: %5.2fx\n", workers, best, baseline / best);
+    }
+
+    std::printf("timestamps (%d records)\n", kRecordCount);
+    double plainSet = bestOf([&]() {
+        for (int i = 0; i < kRecordCount; ++i) {
+            plain[i].dateTime = times[i];
+        }
+        return double(plain.size());
+    }, plainResult);
+    double pooledSet = bestOf([&]() {
+        for (int i = 0; i < kRecordCount; ++i) {
+            records[i].setDateTime(times[i]);
+        }
+        return double(records.size());
+    }, pooledResult);
+    printRow("write", plainSet, pooledSet, plainResult, pooledResult);
+
+    // 按日期区间筛选一年的记录
+    QDate start(2020, 1, 1);
+    QDate end(2020, 12, 31);
+    double plainFilter = bestOf([&]() {
+        int count = 0;
+        for (const auto& record : plain) {
+            QDate date = record.dateTime.date();
+            count += date >= start && date <= end;
+        }
+        return double(count);
+    }, plainResult);
+    double pooledFilter = bestOf([&]() {
+        int count = 0;
+        qint64 startDay = start.toJulianDay();
+        qint64 endDay = end.toJulianDay();
+        for (const auto& record : records) {
+            count += record.getDay() >= startDay && record.getDay() <= endDay;
+        }
+        return double(count);
+    }, pooledResult);
+    printRow("filter by date", plainFilter, pooledFilter, plainResult, pooledResult);
+
+    double plainSort = bestOf([&]() {
+        QVector<const PlainRecord*> order;
+        order.reserve(kRecordCount);
+        for (const auto& record : plain) {
+            order.append(&record);
+        }
+        std::sort(order.begin(), order.end(), [](const PlainRecord* a, const PlainRecord* b) {
+            return a->dateTime < b->dateTime;
+        });
+        return double(order.size());
+    }, plainResult);
+    double pooledSort = bestOf([&]() {
+        QVector<const Record*> order;
+        order.reserve(kRecordCount);
+        for (const auto& record : records) {
+            order.append(&record);
+        }
+        std::sort(order.begin(), order.end(), [](const Record* a, const Record* b) {
+            return a->getTimestamp() < b->getTimestamp();
+        });
+        return double(order.size());
+    }, pooledResult);
+    printRow("sort by time", plainSort, pooledSort, plainResult, pooledResult);
+
+    return 0;
+}
@@ -2,10 +2,18 @@
 #include "../models/Record.h"
 #include "../models/Category.h"
 #include "../models/User.h"
+#include "../models/Budget.h"
+#include "../models/LedgerSnapshot.h"
 #include "../services/ReportService.h"
+#include "../services/LedgerAggregator.h"
+#include "../services/ReminderService.h"
 #include "../services/DataStorageService.h"
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <memory>
+#include <algorithm>
+#include <cmath>
 
 // 自底向上集成测试：从底层模块开始
 
@@ -127,6 +135,1450 @@ TEST(IntegrationTest, DataStorageUserIntegration) {
     // 注意：实际保存可能需要文件或数据库，这里只是集成测试框架
 }
 
+// 第五组：User批量操作与日期索引的集成测试
+TEST(IntegrationTest, UserBatchRecordIntegration) {
+    auto user = std::make_shared<User>("user_004", "Batch User");
+    QDate today = QDate::currentDate();
+
+    QVector<std::shared_ptr<Record>> records;
+    for (int i = 0; i < 10; ++i) {
+        auto record = std::make_shared<Record>();
+        record->setAmount(10.0);
+        record->setType(Record::Type::Expense);
+        record->setDateTime(QDateTime(today.addDays(-i), QTime(12, 0)));
+        records.append(record);
+    }
+    records.append(records[0]); // 重复记录应被忽略
+
+    quint64 versionBefore = user->getDataVersion();
+    user->addRecords(records);
+
+    EXPECT_EQ(user->getAllRecords().size(), 10);
+    EXPECT_EQ(user->getDataVersion(), versionBefore + 1);
+    EXPECT_EQ(user->getRecordsByDateRange(today.addDays(-4), today).size(), 5);
+    EXPECT_DOUBLE_EQ(user->getTotalExpense(today.addDays(-9), today), 100.0);
+
+    user->removeRecords({records[0]->getId(), records[1]->getId()});
+    EXPECT_EQ(user->getDataVersion(), versionBefore + 2);
+    EXPECT_EQ(user->getRecordsByDateRange(today.addDays(-4), today).size(), 3);
+
+    // 删除的行被移除，其余记录保持顺序，ID 释放后可以重新添加
+    ASSERT_EQ(user->getAllRecords().size(), 8);
+    EXPECT_EQ(user->getAllRecords().first(), records[2]);
+    EXPECT_EQ(user->getRecord(records[0]->getId()), nullptr);
+    EXPECT_EQ(user->getRecord(records[5]->getId()), records[5]);
+    user->removeRecord(records[5]->getId());
+    EXPECT_EQ(user->getAllRecords().size(), 7);
+    EXPECT_EQ(user->getRecordsByDateRange(today.addDays(-5), today.addDays(-5)).size(), 0);
+    user->addRecords({records[1], records[5]});
+    EXPECT_FALSE(records[1]->isDeleted());
+    EXPECT_EQ(user->getAllRecords().size(), 9);
+    EXPECT_EQ(user->getRecord(records[5]->getId()), records[5]);
+    EXPECT_EQ(user->getRecordsByDateRange(today.addDays(-5), today).size(), 5);
+    EXPECT_DOUBLE_EQ(user->getTotalExpense(today.addDays(-9), today), 90.0);
+    EXPECT_EQ(user->snapshot()->rowCount(), 9);
+
+    // 原地修改日期后更新索引
+    Record before = *records[9];
+    records[9]->setDateTime(QDateTime(today, QTime(8, 0)));
+    EXPECT_TRUE(user->hasUnreportedEdits());
+    user->updateRecord(records[9], before);
+    EXPECT_FALSE(user->hasUnreportedEdits());
+    EXPECT_EQ(user->getRecordsByDateRange(today, today).size(), 1);
+    EXPECT_EQ(user->getRecord(records[9]->getId()), records[9]);
+
+    // 删除的记录不再计入；未加入账本的记录修改不影响账本
+    records[8]->setAmount(15.0);
+    EXPECT_TRUE(user->hasUnreportedEdits());
+    user->removeRecord(records[8]->getId());
+    EXPECT_FALSE(user->hasUnreportedEdits());
+    records[8]->setAmount(20.0);
+    records[0]->setAmount(20.0);
+    EXPECT_FALSE(user->hasUnreportedEdits());
+    user->addRecord(records[8]);
+    EXPECT_DOUBLE_EQ(user->getTotalExpense(today.addDays(-9), today), 100.0);
+
+    // 只读遍历与按范围取记录结果一致，且按日期升序
+    QVector<const Record*> visited;
+    user->forEachRecordInRange(today.addDays(-9), today, [&visited](const Record& record) {
+        visited.append(&record);
+    });
+    auto ranged = user->getRecordsByDateRange(today.addDays(-9), today);
+    ASSERT_EQ(visited.size(), ranged.size());
+    EXPECT_EQ(user->countRecordsInRange(today.addDays(-9), today), ranged.size());
+    for (int i = 0; i < visited.size(); ++i) {
+        EXPECT_EQ(visited[i], ranged[i].get());
+        if (i > 0) {
+            EXPECT_LE(visited[i - 1]->getDay(), visited[i]->getDay());
+        }
+    }
+}
+
+// 第六组：User变更事件订阅
+TEST(IntegrationTest, UserChangeFeedIntegration) {
+    auto user = std::make_shared<User>("user_005", "Feed User");
+    QVector<User::ChangeEvent> events;
+    int subscriptionId = user->subscribe([&events](const User::ChangeEvent& event) {
+        events.append(event);
+    });
+
+    auto record = std::make_shared<Record>();
+    record->setAmount(20.0);
+    record->setDateTime(QDateTime::currentDateTime());
+    user->addRecord(record);
+
+    Record before = *record;
+    record->setAmount(35.0);
+    user->updateRecord(record, before);
+    user->removeRecord(record->getId());
+
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0].kind, User::ChangeEvent::Kind::RecordsAdded);
+    EXPECT_EQ(events[1].kind, User::ChangeEvent::Kind::RecordModified);
+    EXPECT_DOUBLE_EQ(events[1].before->getAmount(), 20.0);
+    EXPECT_DOUBLE_EQ(events[1].records[0]->getAmount(), 35.0);
+    EXPECT_EQ(events[2].kind, User::ChangeEvent::Kind::RecordsRemoved);
+    EXPECT_EQ(events[2].version, user->getDataVersion());
+
+    user->unsubscribe(subscriptionId);
+    user->addRecord(std::make_shared<Record>());
+    EXPECT_EQ(events.size(), 3);
+}
+
+// 第七组：预算已用金额由记录变更自动维护（含子分类与预算周期）
+TEST(IntegrationTest, BudgetUsageMaintainedByUser) {
+    auto user = std::make_shared<User>("user_006", "Budget User");
+
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+
+    auto lunch = std::make_shared<Category>();
+    lunch->setName("Lunch");
+    lunch->setParentId(food->getId());
+    user->addCategory(lunch);
+
+    QDate today = QDate::currentDate();
+    auto budget = std::make_shared<Budget>();
+    budget->setCategoryId(food->getId());
+    budget->setTotalAmount(100.0);
+    budget->setStartDate(today.addDays(-1));
+    budget->setEndDate(today.addDays(1));
+    user->addBudget(budget);
+
+    auto inWindow = std::make_shared<Record>();
+    inWindow->setCategoryId(lunch->getId());
+    inWindow->setAmount(30.0);
+    inWindow->setDateTime(QDateTime(today, QTime(12, 0)));
+    user->addRecord(inWindow);
+
+    auto outOfWindow = std::make_shared<Record>();
+    outOfWindow->setCategoryId(food->getId());
+    outOfWindow->setAmount(50.0);
+    outOfWindow->setDateTime(QDateTime(today.addDays(-10), QTime(12, 0)));
+    user->addRecord(outOfWindow);
+
+    EXPECT_DOUBLE_EQ(budget->getUsedAmount(), 30.0);
+
+    Record before = *inWindow;
+    inWindow->setAmount(90.0);
+    user->updateRecord(inWindow, before);
+    EXPECT_DOUBLE_EQ(budget->getUsedAmount(), 90.0);
+    EXPECT_EQ(budget->getStatus(), Budget::Status::Warning);
+
+    user->removeRecord(inWindow->getId());
+    EXPECT_DOUBLE_EQ(budget->getUsedAmount(), 0.0);
+}
+
+// 第八组：同一分类的周度与月度预算同时生效
+TEST(IntegrationTest, OverlappingBudgetsPerCategory) {
+    auto user = std::make_shared<User>("user_007", "Multi Budget User");
+    auto food = std::make_shared<Category>();
+    user->addCategory(food);
+
+    auto weekly = std::make_shared<Budget>();
+    weekly->setCategoryId(food->getId());
+    weekly->setTotalAmount(100.0);
+    weekly->setPeriod(Budget::Period::Weekly);
+    weekly->resetForNewPeriod();
+    user->addBudget(weekly);
+
+    auto monthly = std::make_shared<Budget>();
+    monthly->setCategoryId(food->getId());
+    monthly->setTotalAmount(400.0);
+    monthly->setPeriod(Budget::Period::Monthly);
+    monthly->resetForNewPeriod();
+    user->addBudget(monthly);
+
+    auto record = std::make_shared<Record>();
+    record->setCategoryId(food->getId());
+    record->setAmount(40.0);
+    record->setDateTime(QDateTime::currentDateTime());
+    user->addRecord(record);
+
+    EXPECT_EQ(user->getBudgets(food->getId()).size(), 2);
+    EXPECT_EQ(user->getBudgetsForDate(food->getId(), QDate::currentDate()).size(), 2);
+    EXPECT_DOUBLE_EQ(weekly->getUsedAmount(), 40.0);
+    EXPECT_DOUBLE_EQ(monthly->getUsedAmount(), 40.0);
+
+    user->removeBudget(weekly->getId());
+    EXPECT_EQ(user->getBudget(food->getId()), monthly);
+
+    // 先记到尚未创建的子分类上，子分类挂到 food 下后 food 的预算重新累计
+    auto snack = std::make_shared<Category>();
+    auto snackRecord = std::make_shared<Record>();
+    snackRecord->setCategoryId(snack->getId());
+    snackRecord->setAmount(15.0);
+    snackRecord->setDateTime(QDateTime::currentDateTime());
+    user->addRecord(snackRecord);
+    EXPECT_DOUBLE_EQ(monthly->getUsedAmount(), 40.0);
+    snack->setParentId(food->getId());
+    user->addCategory(snack);
+    EXPECT_DOUBLE_EQ(monthly->getUsedAmount(), 55.0);
+
+    // 子树不变的预算不重新累计
+    auto travel = std::make_shared<Category>();
+    auto travelBudget = std::make_shared<Budget>();
+    travelBudget->setCategoryId(travel->getId());
+    travelBudget->setTotalAmount(100.0);
+    user->addCategory(travel);
+    user->addBudget(travelBudget);
+    monthly->setUsedAmount(-1.0);
+    user->addCategory(std::make_shared<Category>());
+    EXPECT_DOUBLE_EQ(monthly->getUsedAmount(), -1.0);
+    snack->setParentId(QString());
+    user->updateCategory(snack);
+    EXPECT_DOUBLE_EQ(monthly->getUsedAmount(), 40.0);
+
+    // 删除分类时一并删除该分类的预算
+    int removedBudgets = 0;
+    user->subscribe([&removedBudgets](const User::ChangeEvent& event) {
+        if (event.kind == User::ChangeEvent::Kind::BudgetRemoved) {
+            ++removedBudgets;
+        }
+    });
+    user->removeCategory(food->getId());
+    EXPECT_EQ(removedBudgets, 1);
+    EXPECT_TRUE(user->getBudgets(food->getId()).isEmpty());
+    ASSERT_EQ(user->getAllBudgets().size(), 1);
+    EXPECT_EQ(user->getAllBudgets().first(), travelBudget);
+}
+
+// 第九组：账本快照的版本发布与数据块共享
+TEST(IntegrationTest, LedgerSnapshotVersions) {
+    auto user = std::make_shared<User>("user_008", "Snapshot User");
+    auto food = std::make_shared<Category>();
+    user->addCategory(food);
+    QDate first(2024, 1, 1);
+
+    // 100天、每天100条，共10000条，超过两个数据块
+    QVector<std::shared_ptr<Record>> records;
+    for (int day = 0; day < 100; ++day) {
+        for (int i = 0; i < 100; ++i) {
+            auto record = Record::create();
+            record->setCategoryId(food->getId());
+            record->setAmount(1.0);
+            record->setDateTime(QDateTime(first.addDays(day), QTime(12, 0)));
+            records.append(record);
+        }
+    }
+    user->addRecords(records);
+
+    auto snapshot = user->snapshot();
+    EXPECT_EQ(snapshot->version(), user->getDataVersion());
+    EXPECT_EQ(snapshot->rowCount(), 10000);
+    EXPECT_GE(snapshot->chunks().size(), 3);
+    EXPECT_EQ(snapshot->countInRange(first, first.addDays(9)), 1000);
+    EXPECT_DOUBLE_EQ(snapshot->totalInRange(first, first.addDays(99), Record::Type::Expense),
+                     user->getTotalExpense(first, first.addDays(99)));
+    QVector<double> totals = snapshot->categoryTotals(first, first.addDays(4), Record::Type::Expense);
+    EXPECT_DOUBLE_EQ(totals[snapshot->hierarchy().indexOf(food->getId())], 500.0);
+
+    // 修改最后一天的记录只重建最后一个块
+    Record before = *records.last();
+    records.last()->setAmount(101.0);
+    user->updateRecord(records.last(), before);
+
+    auto next = user->snapshot();
+    EXPECT_EQ(next->version(), snapshot->version() + 1);
+    EXPECT_EQ(next->chunks().first(), snapshot->chunks().first());
+    EXPECT_NE(next->chunks().last(), snapshot->chunks().last());
+    EXPECT_DOUBLE_EQ(next->totalInRange(first, first.addDays(99), Record::Type::Expense), 10100.0);
+    // 旧快照保持不变
+    EXPECT_DOUBLE_EQ(snapshot->totalInRange(first, first.addDays(99), Record::Type::Expense), 10000.0);
+
+    user->removeRecords({records[0]->getId(), records[1]->getId()});
+    EXPECT_EQ(user->snapshot()->rowCount(), 9998);
+    EXPECT_EQ(user->snapshot()->countInRange(first, first), 98);
+
+    // 删除第一天的记录只重建第一个块，之后的块继续共享
+    auto beforeRemove = user->snapshot();
+    user->removeRecord(records[2]->getId());
+    auto afterRemove = user->snapshot();
+    ASSERT_EQ(afterRemove->chunks().size(), beforeRemove->chunks().size());
+    EXPECT_NE(afterRemove->chunks().first(), beforeRemove->chunks().first());
+    for (int i = 1; i < afterRemove->chunks().size(); ++i) {
+        EXPECT_EQ(afterRemove->chunks()[i], beforeRemove->chunks()[i]);
+    }
+    EXPECT_EQ(user->getAllRecords().size(), 9997);
+    EXPECT_EQ(user->getAllRecords().first(), records[3]);
+    EXPECT_EQ(user->countRecordsInRange(first, first), 97);
+
+    // 删除过半后压缩，剩余记录保持顺序
+    QVector<QString> ids;
+    for (int i = 3; i < 6000; ++i) {
+        ids.append(records[i]->getId());
+    }
+    user->removeRecords(ids);
+    auto remaining = user->getAllRecords();
+    ASSERT_EQ(remaining.size(), 4000);
+    EXPECT_EQ(remaining.first(), records[6000]);
+    EXPECT_EQ(remaining.last(), records.last());
+    EXPECT_EQ(user->getRecord(records[7000]->getId()), records[7000]);
+    EXPECT_EQ(user->snapshot()->rowCount(), 4000);
+    EXPECT_DOUBLE_EQ(user->getTotalExpense(first, first.addDays(99)), 4100.0);
+}
+
+// 第十组：ReportService在线程池中基于快照异步生成报告
+TEST(IntegrationTest, ReportServiceAsyncStatistics) {
+    auto user = std::make_shared<User>("user_009", "Async User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+
+    QDate today = QDate::currentDate();
+    for (int i = 0; i < 5; ++i) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(20.0);
+        record->setType(i == 0 ? Record::Type::Income : Record::Type::Expense);
+        record->setDateTime(QDateTime(today.addDays(-i), QTime(9, 0)));
+        user->addRecord(record);
+    }
+
+    ReportService reportService(user);
+    auto stale = reportService.generateStatisticsAsync(today.addDays(-1), today);
+    auto future = reportService.generateStatisticsAsync(today.addDays(-4), today);
+    EXPECT_TRUE(stale.isCanceled() || stale.isFinished());
+
+    future.waitForFinished();
+    ASSERT_EQ(future.resultCount(), 1);
+    ReportService::StatisticsData data = future.result();
+    EXPECT_DOUBLE_EQ(data.totalIncome, 20.0);
+    EXPECT_DOUBLE_EQ(data.totalExpense, 80.0);
+    EXPECT_EQ(data.transactionCount, 5);
+    EXPECT_DOUBLE_EQ(data.categoryExpenses.value("Food"), 80.0);
+
+    // 同步接口与异步结果一致
+    EXPECT_DOUBLE_EQ(reportService.generateStatistics(today.addDays(-4), today).totalExpense, 80.0);
+
+    auto chart = reportService.generateChartDataAsync(ReportService::ReportType::TrendAnalysis,
+                                                      ReportService::TimeDimension::Daily,
+                                                      today.addDays(-4), today);
+    chart.waitForFinished();
+    EXPECT_EQ(chart.result().keys.size(), 5);
+    EXPECT_DOUBLE_EQ(chart.result().incomeValues.last(), 20.0);
+}
+
+// 第十一组：并行聚合与串行聚合结果一致
+TEST(IntegrationTest, LedgerAggregatorParallelMatchesSerial) {
+    auto user = std::make_shared<User>("user_010", "Aggregator User");
+    auto food = std::make_shared<Category>();
+    auto salary = std::make_shared<Category>();
+    user->addCategory(food);
+    user->addCategory(salary);
+    QDate first(2023, 1, 1);
+
+    // 200天、每天60条，共12000条，分布在多个数据块中
+    QVector<std::shared_ptr<Record>> records;
+    for (int day = 0; day < 200; ++day) {
+        for (int i = 0; i < 60; ++i) {
+            auto record = Record::create();
+            bool income = i % 10 == 0;
+            record->setCategoryId(income ? salary->getId() : food->getId());
+            record->setType(income ? Record::Type::Income : Record::Type::Expense);
+            record->setAmount(1.0 + (day * 60 + i) % 7);
+            record->setDateTime(QDateTime(first.addDays(day), QTime(8, 0)));
+            records.append(record);
+        }
+    }
+    user->addRecords(records);
+
+    auto snapshot = user->snapshot();
+    ASSERT_GE(snapshot->chunks().size(), 3);
+    QDate start = first.addDays(10);
+    QDate end = first.addDays(180);
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    auto serial = LedgerAggregator::aggregate(*snapshot, start, end, &pool, 1);
+    auto parallel = LedgerAggregator::aggregate(*snapshot, start, end, &pool, 4);
+
+    EXPECT_EQ(serial.transactionCount, 171 * 60);
+    EXPECT_EQ(parallel.transactionCount, serial.transactionCount);
+    EXPECT_DOUBLE_EQ(serial.totalExpense, user->getTotalExpense(start, end));
+    EXPECT_DOUBLE_EQ(parallel.totalExpense, serial.totalExpense);
+    EXPECT_DOUBLE_EQ(parallel.totalIncome, user->getTotalIncome(start, end));
+    ASSERT_EQ(parallel.dayCount(), 171);
+    EXPECT_EQ(parallel.dateAt(0), start);
+    EXPECT_EQ(parallel.dailyExpense, serial.dailyExpense);
+    EXPECT_EQ(parallel.dailyIncome, serial.dailyIncome);
+    int foodIndex = snapshot->hierarchy().indexOf(food->getId());
+    EXPECT_DOUBLE_EQ(parallel.categoryExpense[foodIndex], serial.totalExpense);
+
+    // 范围超出数据时每日数组只覆盖有数据的日期
+    auto all = LedgerAggregator::aggregate(*snapshot, first.addDays(-30), first.addDays(400), &pool, 4);
+    EXPECT_EQ(all.dayCount(), 200);
+    EXPECT_EQ(all.transactionCount, 12000);
+
+    // 已取消的聚合不再处理数据块
+    auto canceled = LedgerAggregator::aggregate(*snapshot, start, end, &pool, 4, []() { return true; });
+    EXPECT_EQ(canceled.transactionCount, 0);
+
+    // 未设置时间的记录不进入快照，起止日期无效时返回空结果
+    auto undated = Record::create();
+    undated->setCategoryId(food->getId());
+    undated->setAmount(99.0);
+    user->addRecord(undated);
+    auto withUndated = user->snapshot();
+    EXPECT_EQ(withUndated->rowCount(), 12000);
+    EXPECT_EQ(withUndated->chunks().first()->minDay, first.toJulianDay());
+    auto stillAll = LedgerAggregator::aggregate(*withUndated, first.addDays(-30), first.addDays(400), &pool, 4);
+    EXPECT_EQ(stillAll.dayCount(), 200);
+    EXPECT_EQ(stillAll.transactionCount, 12000);
+    auto invalid = LedgerAggregator::aggregate(*withUndated, QDate(), end, &pool, 4);
+    EXPECT_EQ(invalid.dayCount(), 0);
+    EXPECT_EQ(invalid.transactionCount, 0);
+    auto daily = LedgerAggregator::categoryDaily(*withUndated, first, first.addDays(400), Record::Type::Expense);
+    EXPECT_EQ(daily.dayCount, 200);
+}
+
+// 第十二组：趋势图按周、月、年合并每日收支
+TEST(IntegrationTest, ReportServiceTrendBuckets) {
+    auto user = std::make_shared<User>("user_011", "Trend User");
+    auto food = std::make_shared<Category>();
+    user->addCategory(food);
+
+    // 2023-12-31（周日）至2024-03-02，每天支出1元；2月15日另有收入100元
+    QDate first(2023, 12, 31);
+    QDate last(2024, 3, 2);
+    for (QDate day = first; day <= last; day = day.addDays(1)) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(1.0);
+        record->setDateTime(QDateTime(day, QTime(12, 0)));
+        user->addRecord(record);
+    }
+    auto salary = Record::create();
+    salary->setType(Record::Type::Income);
+    salary->setAmount(100.0);
+    salary->setDateTime(QDateTime(QDate(2024, 2, 15), QTime(9, 0)));
+    user->addRecord(salary);
+
+    ReportService reportService(user);
+    auto monthly = reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                                   ReportService::TimeDimension::Monthly, first, last);
+    EXPECT_EQ(monthly.dimension, ReportService::TimeDimension::Monthly);
+    ASSERT_EQ(monthly.keys.size(), 4);
+    EXPECT_EQ(QDate::fromJulianDay(qint64(monthly.keys[0])), QDate(2023, 12, 1));
+    EXPECT_EQ(QDate::fromJulianDay(qint64(monthly.keys[2])), QDate(2024, 2, 1));
+    EXPECT_DOUBLE_EQ(monthly.values[0], 1.0);
+    EXPECT_DOUBLE_EQ(monthly.values[1], 31.0);
+    EXPECT_DOUBLE_EQ(monthly.values[2], 29.0);
+    EXPECT_DOUBLE_EQ(monthly.values[3], 2.0);
+    EXPECT_DOUBLE_EQ(monthly.incomeValues[2], 100.0);
+
+    // 周从周一开始，2023-12-31属于前一周
+    auto weekly = reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                                  ReportService::TimeDimension::Weekly, first, last);
+    ASSERT_EQ(weekly.keys.size(), 10);
+    EXPECT_EQ(QDate::fromJulianDay(qint64(weekly.keys[1])), QDate(2024, 1, 1));
+    EXPECT_DOUBLE_EQ(weekly.values[0], 1.0);
+    EXPECT_DOUBLE_EQ(weekly.values[1], 7.0);
+
+    auto yearly = reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                                  ReportService::TimeDimension::Yearly, first, last);
+    ASSERT_EQ(yearly.keys.size(), 2);
+    EXPECT_DOUBLE_EQ(yearly.values[1], 62.0);
+
+    // 查询范围从区间中间开始时只统计范围内的日期
+    auto partial = reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                                   ReportService::TimeDimension::Monthly,
+                                                   QDate(2024, 1, 20), QDate(2024, 2, 10));
+    ASSERT_EQ(partial.keys.size(), 2);
+    EXPECT_DOUBLE_EQ(partial.values[0], 12.0);
+    EXPECT_DOUBLE_EQ(partial.values[1], 10.0);
+    EXPECT_EQ(ReportService::bucketStart(QDate(2024, 2, 29), ReportService::TimeDimension::Weekly),
+              QDate(2024, 2, 26));
+}
+
+// 第十三组：分类 × 月份立方体随记录变更增量维护
+TEST(IntegrationTest, ReportServiceCategoryMonthCube) {
+    auto user = std::make_shared<User>("user_012", "Cube User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    auto lunch = std::make_shared<Category>();
+    lunch->setName("Lunch");
+    lunch->setParentId(food->getId());
+    user->addCategory(lunch);
+
+    ReportService reportService(user);
+    QVector<std::shared_ptr<Record>> records;
+    for (int day = 0; day < 90; ++day) {
+        auto record = Record::create();
+        record->setCategoryId(day % 2 == 0 ? food->getId() : lunch->getId());
+        record->setAmount(1.0 + day % 5);
+        record->setDateTime(QDateTime(QDate(2024, 1, 1).addDays(day), QTime(12, 0)));
+        records.append(record);
+    }
+    user->addRecords(records);
+
+    // 立方体结果与扫描快照的结果一致，包括不足整月的范围
+    auto snapshot = user->snapshot();
+    QVector<QPair<QDate, QDate>> ranges = {
+        {QDate(2024, 1, 1), QDate(2024, 3, 31)},
+        {QDate(2024, 1, 10), QDate(2024, 3, 5)},
+        {QDate(2024, 2, 3), QDate(2024, 2, 20)},
+        {QDate(2023, 11, 1), QDate(2024, 12, 31)}
+    };
+    for (const auto& range : ranges) {
+        EXPECT_EQ(reportService.getCategoryExpenseDistribution(range.first, range.second),
+                  ReportService::computeCategoryDistribution(*snapshot, Record::Type::Expense,
+                                                             range.first, range.second));
+    }
+
+    // 修改、删除记录后增量更新
+    Record before = *records[0];
+    records[0]->setAmount(50.0);
+    records[0]->setCategoryId(lunch->getId());
+    user->updateRecord(records[0], before);
+    user->removeRecord(records[1]->getId());
+    auto distribution = reportService.getCategoryExpenseDistribution(QDate(2024, 1, 1), QDate(2024, 1, 31));
+    EXPECT_EQ(distribution, ReportService::computeCategoryDistribution(*user->snapshot(), Record::Type::Expense,
+                                                                        QDate(2024, 1, 1), QDate(2024, 1, 31)));
+    EXPECT_DOUBLE_EQ(reportService.getCategoryExpenseRollup(QDate(2024, 1, 1), QDate(2024, 1, 31)).value("Food"),
+                     user->getTotalExpense(QDate(2024, 1, 1), QDate(2024, 1, 31)));
+
+    // 子树逐月合计
+    auto trend = reportService.getCategoryMonthlyTrend(food->getId(), Record::Type::Expense,
+                                                       QDate(2024, 1, 1), QDate(2024, 3, 31));
+    ASSERT_EQ(trend.size(), 3);
+    EXPECT_DOUBLE_EQ(trend.value(QDate(2024, 2, 1)), user->getTotalExpense(QDate(2024, 2, 1), QDate(2024, 2, 29)));
+
+    // 新增分类改变先序编号后重建
+    auto drinks = std::make_shared<Category>();
+    drinks->setName("Drinks");
+    user->addCategory(drinks);
+    before = *records[2];
+    records[2]->setCategoryId(drinks->getId());
+    user->updateRecord(records[2], before);
+    EXPECT_EQ(reportService.getCategoryExpenseDistribution(QDate(2024, 1, 1), QDate(2024, 3, 31)),
+              ReportService::computeCategoryDistribution(*user->snapshot(), Record::Type::Expense,
+                                                         QDate(2024, 1, 1), QDate(2024, 3, 31)));
+}
+
+// 第十四组：报告结果缓存随数据版本失效
+TEST(IntegrationTest, ReportServiceResultCache) {
+    auto user = std::make_shared<User>("user_013", "Cache User");
+    QDate day(2024, 5, 10);
+    auto record = Record::create();
+    record->setAmount(30.0);
+    record->setDateTime(QDateTime(day, QTime(10, 0)));
+    user->addRecord(record);
+
+    ReportService reportService(user);
+    EXPECT_DOUBLE_EQ(reportService.generateStatistics(day, day).totalExpense, 30.0);
+    EXPECT_DOUBLE_EQ(reportService.generateStatistics(day, day).totalExpense, 30.0);
+    EXPECT_EQ(reportService.cacheStats().misses, 1u);
+    EXPECT_EQ(reportService.cacheStats().hits, 1u);
+
+    // 相同范围的不同图表类型和粒度分别缓存
+    reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                    ReportService::TimeDimension::Daily, day, day);
+    reportService.generateChartData(ReportService::ReportType::TrendAnalysis,
+                                    ReportService::TimeDimension::Monthly, day, day);
+    EXPECT_EQ(reportService.cacheStats().misses, 3u);
+
+    // 异步请求命中缓存时直接返回已完成的结果
+    auto future = reportService.generateStatisticsAsync(day, day);
+    EXPECT_TRUE(future.isFinished());
+    EXPECT_DOUBLE_EQ(future.result().totalExpense, 30.0);
+    EXPECT_EQ(reportService.cacheStats().hits, 2u);
+
+    // 数据变化后重新计算
+    auto second = Record::create();
+    second->setAmount(20.0);
+    second->setDateTime(QDateTime(day, QTime(11, 0)));
+    user->addRecord(second);
+    EXPECT_DOUBLE_EQ(reportService.generateStatistics(day, day).totalExpense, 50.0);
+    EXPECT_EQ(reportService.cacheStats().misses, 4u);
+
+    // 超出容量时淘汰最久未使用的结果
+    for (int i = 1; i <= ReportService::kCacheCapacity; ++i) {
+        reportService.generateStatistics(day.addDays(-i), day);
+    }
+    EXPECT_EQ(reportService.cacheStats().misses, 4u + ReportService::kCacheCapacity);
+    reportService.generateStatistics(day.addDays(-ReportService::kCacheCapacity), day);
+    EXPECT_EQ(reportService.cacheStats().hits, 3u);
+    reportService.generateStatistics(day, day);
+    EXPECT_EQ(reportService.cacheStats().misses, 5u + ReportService::kCacheCapacity);
+}
+
+// 第十五组：预算执行报告（含历史周期）
+TEST(IntegrationTest, ReportServiceBudgetPerformance) {
+    auto user = std::make_shared<User>("user_014", "Performance User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    auto lunch = std::make_shared<Category>();
+    lunch->setName("Lunch");
+    lunch->setParentId(food->getId());
+    user->addCategory(lunch);
+    auto rent = std::make_shared<Category>();
+    rent->setName("Rent");
+    user->addCategory(rent);
+
+    // 2024-01-01 至 2024-05-31 每天午餐2元，每月1日房租1000元
+    QVector<std::shared_ptr<Record>> records;
+    for (QDate day(2024, 1, 1); day <= QDate(2024, 5, 31); day = day.addDays(1)) {
+        auto record = Record::create();
+        record->setCategoryId(lunch->getId());
+        record->setAmount(2.0);
+        record->setDateTime(QDateTime(day, QTime(12, 0)));
+        records.append(record);
+        if (day.day() == 1) {
+            auto payment = Record::create();
+            payment->setCategoryId(rent->getId());
+            payment->setAmount(1000.0);
+            payment->setDateTime(QDateTime(day, QTime(9, 0)));
+            records.append(payment);
+        }
+    }
+    user->addRecords(records);
+
+    auto monthly = std::make_shared<Budget>();
+    monthly->setCategoryId(food->getId());
+    monthly->setTotalAmount(50.0);
+    monthly->setPeriod(Budget::Period::Monthly);
+    monthly->setStartDate(QDate(2024, 5, 1));
+    monthly->setEndDate(QDate(2024, 5, 31));
+    user->addBudget(monthly);
+
+    auto weekly = std::make_shared<Budget>();
+    weekly->setCategoryId(rent->getId());
+    weekly->setTotalAmount(500.0);
+    weekly->setPeriod(Budget::Period::Weekly);
+    weekly->setStartDate(QDate(2024, 4, 29));
+    weekly->setEndDate(QDate(2024, 5, 5));
+    user->addBudget(weekly);
+
+    ReportService reportService(user);
+    auto performance = reportService.getBudgetPerformance(QDate(2024, 5, 3), 3);
+    ASSERT_EQ(performance.size(), 2);
+
+    // 父分类预算包含子分类支出；历史周期为之前的自然月
+    const auto& foodBudget = performance[0];
+    EXPECT_EQ(foodBudget.label, "Food（月度）");
+    ASSERT_EQ(foodBudget.periods.size(), 4);
+    EXPECT_EQ(foodBudget.periods[0].startDate, QDate(2024, 2, 1));
+    EXPECT_EQ(foodBudget.periods[0].endDate, QDate(2024, 2, 29));
+    EXPECT_DOUBLE_EQ(foodBudget.periods[0].actual, 58.0);
+    EXPECT_DOUBLE_EQ(foodBudget.periods[1].actual, 62.0);
+    EXPECT_DOUBLE_EQ(foodBudget.periods[3].actual, monthly->getUsedAmount());
+    EXPECT_DOUBLE_EQ(foodBudget.periods[3].budgeted, 50.0);
+
+    const auto& rentBudget = performance[1];
+    ASSERT_EQ(rentBudget.periods.size(), 4);
+    EXPECT_EQ(rentBudget.periods[2].startDate, QDate(2024, 4, 22));
+    EXPECT_DOUBLE_EQ(rentBudget.periods[2].actual, 0.0);
+    EXPECT_DOUBLE_EQ(rentBudget.periods[3].actual, 1000.0);
+    EXPECT_EQ(rentBudget.periods[0].startDate, QDate(2024, 4, 8));
+    EXPECT_DOUBLE_EQ(rentBudget.periods[0].actual, 0.0);
+
+    // 使用率与 User 增量维护的已用金额一致
+    auto usage = reportService.getBudgetUsageReport(QDate(2024, 5, 3));
+    EXPECT_EQ(usage.value(monthly->getId()).label, "Food（月度）");
+    EXPECT_DOUBLE_EQ(usage.value(monthly->getId()).usage, monthly->getUsagePercentage());
+    EXPECT_DOUBLE_EQ(usage.value(weekly->getId()).usage, weekly->getUsagePercentage());
+
+    auto chart = reportService.generateChartData(ReportService::ReportType::BudgetPerformance,
+                                                 ReportService::TimeDimension::Monthly,
+                                                 QDate(2024, 5, 1), QDate(2024, 5, 3));
+    ASSERT_EQ(chart.labels.size(), 2);
+    EXPECT_DOUBLE_EQ(chart.values[1], 1000.0);
+    EXPECT_DOUBLE_EQ(chart.budgetValues[1], 500.0);
+
+    // 未设置起止日期的周期预算也计入使用率报告
+    auto yearly = std::make_shared<Budget>();
+    yearly->setCategoryId(rent->getId());
+    yearly->setTotalAmount(20000.0);
+    yearly->setPeriod(Budget::Period::Yearly);
+    user->addBudget(yearly);
+    usage = reportService.getBudgetUsageReport(QDate(2024, 5, 3));
+    EXPECT_EQ(usage.size(), 3);
+    EXPECT_DOUBLE_EQ(usage.value(yearly->getId()).usage, 0.25);
+
+    // 同一分类、同一周期类型的两个预算各占一项
+    auto secondWeekly = std::make_shared<Budget>();
+    secondWeekly->setCategoryId(rent->getId());
+    secondWeekly->setTotalAmount(2000.0);
+    secondWeekly->setPeriod(Budget::Period::Weekly);
+    secondWeekly->setStartDate(QDate(2024, 4, 29));
+    secondWeekly->setEndDate(QDate(2024, 5, 5));
+    user->addBudget(secondWeekly);
+    usage = reportService.getBudgetUsageReport(QDate(2024, 5, 3));
+    EXPECT_EQ(usage.size(), 4);
+    EXPECT_EQ(usage.value(secondWeekly->getId()).label, usage.value(weekly->getId()).label);
+    EXPECT_DOUBLE_EQ(usage.value(weekly->getId()).usage, 2.0);
+    EXPECT_DOUBLE_EQ(usage.value(secondWeekly->getId()).usage, 0.5);
+
+    // 周期从开始日起排列：月中开始的月度预算、周三开始的周度预算
+    Budget midMonth;
+    midMonth.setCategoryId(food->getId());
+    midMonth.setTotalAmount(100.0);
+    midMonth.setPeriod(Budget::Period::Monthly);
+    midMonth.setStartDate(QDate(2024, 1, 15));
+    Budget fromWednesday;
+    fromWednesday.setCategoryId(rent->getId());
+    fromWednesday.setTotalAmount(100.0);
+    fromWednesday.setPeriod(Budget::Period::Weekly);
+    fromWednesday.setStartDate(QDate(2024, 4, 3));
+    fromWednesday.setEndDate(QDate(2024, 5, 31));
+    auto anchored = ReportService::computeBudgetPerformance(*user->snapshot(), {midMonth, fromWednesday},
+                                                            QDate(2024, 3, 20), 1);
+    ASSERT_EQ(anchored.size(), 2);
+    ASSERT_EQ(anchored[0].periods.size(), 2);
+    EXPECT_EQ(anchored[0].periods[0].startDate, QDate(2024, 2, 15));
+    EXPECT_EQ(anchored[0].periods[0].endDate, QDate(2024, 3, 14));
+    EXPECT_EQ(anchored[0].periods[1].startDate, QDate(2024, 3, 15));
+    EXPECT_EQ(anchored[0].periods[1].endDate, QDate(2024, 4, 14));
+    EXPECT_DOUBLE_EQ(anchored[0].periods[0].actual, 29 * 2.0);
+    // date 早于开始日时取第一个周期
+    EXPECT_EQ(anchored[1].periods[1].startDate, QDate(2024, 4, 3));
+    EXPECT_EQ(anchored[1].periods[1].endDate, QDate(2024, 4, 9));
+    auto laterWeek = ReportService::computeBudgetPerformance(*user->snapshot(), {fromWednesday},
+                                                             QDate(2024, 5, 2), 1);
+    EXPECT_EQ(laterWeek[0].periods[1].startDate, QDate(2024, 5, 1));
+    EXPECT_EQ(laterWeek[0].periods[1].endDate, QDate(2024, 5, 7));
+    EXPECT_DOUBLE_EQ(laterWeek[0].periods[1].actual, 1000.0);
+    EXPECT_EQ(laterWeek[0].periods[0].startDate, QDate(2024, 4, 24));
+    // 当前周期不超过结束日
+    auto lastWeek = ReportService::computeBudgetPerformance(*user->snapshot(), {fromWednesday},
+                                                            QDate(2024, 7, 1), 0);
+    EXPECT_EQ(lastWeek[0].periods[0].startDate, QDate(2024, 5, 29));
+    EXPECT_EQ(lastWeek[0].periods[0].endDate, QDate(2024, 5, 31));
+
+    // 按日矩阵只覆盖有数据的日期
+    auto daily = LedgerAggregator::categoryDaily(*user->snapshot(), QDate(2000, 1, 1), QDate(2030, 12, 31),
+                                                 Record::Type::Expense);
+    EXPECT_EQ(daily.firstDay, QDate(2024, 1, 1).toJulianDay());
+    EXPECT_EQ(daily.dayCount, 152);
+    EXPECT_DOUBLE_EQ(daily.prefixSums(0, daily.categoryCount).last(), 152 * 2.0 + 5 * 1000.0);
+}
+
+// 第十六组：滚动窗口支出与分类环比、同比
+TEST(IntegrationTest, ReportServiceRollingAndComparison) {
+    auto user = std::make_shared<User>("user_015", "Rolling User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    auto rent = std::make_shared<Category>();
+    rent->setName("Rent");
+    user->addCategory(rent);
+
+    // 2023年每天餐饮1元，2024年起每天2元；2024-02-05 房租1000元
+    QVector<std::shared_ptr<Record>> records;
+    for (QDate day(2023, 1, 1); day <= QDate(2024, 3, 31); day = day.addDays(1)) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(day.year() == 2023 ? 1.0 : 2.0);
+        record->setDateTime(QDateTime(day, QTime(12, 0)));
+        records.append(record);
+    }
+    auto payment = Record::create();
+    payment->setCategoryId(rent->getId());
+    payment->setAmount(1000.0);
+    payment->setDateTime(QDateTime(QDate(2024, 2, 5), QTime(9, 0)));
+    records.append(payment);
+    user->addRecords(records);
+
+    // 滑动窗口结果与逐日按范围求和一致，范围第一天的窗口包含范围之前的数据
+    auto snapshot = user->snapshot();
+    QDate start(2024, 1, 1);
+    QDate end(2024, 4, 10);
+    auto rolling = ReportService::computeRollingSpend(*snapshot, start, end);
+    ASSERT_EQ(rolling.totals.size(), 3);
+    EXPECT_DOUBLE_EQ(rolling.totals[0][0], 8.0);
+    EXPECT_DOUBLE_EQ(rolling.totals[1][0], 31.0);
+    EXPECT_DOUBLE_EQ(rolling.totals[2][0], 91.0);
+    for (int w = 0; w < rolling.windows.size(); ++w) {
+        ASSERT_EQ(rolling.totals[w].size(), start.daysTo(end) + 1);
+        for (int i = 0; i < rolling.totals[w].size(); ++i) {
+            QDate day = start.addDays(i);
+            EXPECT_NEAR(rolling.totals[w][i],
+                        user->getTotalExpense(day.addDays(1 - rolling.windows[w]), day), 1e-9);
+        }
+    }
+
+    // 与上月同期、去年同期比较
+    auto comparison = ReportService::computeCategoryComparison(*snapshot, QDate(2024, 3, 1), QDate(2024, 3, 10));
+    ASSERT_EQ(comparison.size(), 2);
+    EXPECT_EQ(comparison[0].label, "Food");
+    EXPECT_DOUBLE_EQ(comparison[0].current, 20.0);
+    EXPECT_DOUBLE_EQ(comparison[0].previousMonth, 20.0);
+    EXPECT_DOUBLE_EQ(comparison[0].previousYear, 10.0);
+    EXPECT_DOUBLE_EQ(comparison[0].yearOverYear(), 10.0);
+    EXPECT_EQ(comparison[1].label, "Rent");
+    EXPECT_DOUBLE_EQ(comparison[1].current, 0.0);
+    EXPECT_DOUBLE_EQ(comparison[1].monthOverMonth(), -1000.0);
+
+    ReportService reportService(user);
+    auto chart = reportService.generateChartData(ReportService::ReportType::PeriodComparison,
+                                                 ReportService::TimeDimension::Daily,
+                                                 QDate(2024, 3, 1), QDate(2024, 3, 10));
+    ASSERT_EQ(chart.seriesValues.size(), 3);
+    EXPECT_EQ(chart.labels.size(), 2);
+    EXPECT_DOUBLE_EQ(chart.seriesValues[1][1], 1000.0);
+    auto rollingChart = reportService.generateChartData(ReportService::ReportType::RollingSpend,
+                                                        ReportService::TimeDimension::Daily, start, end);
+    ASSERT_EQ(rollingChart.seriesNames.size(), 3);
+    EXPECT_EQ(rollingChart.seriesNames[1], "近30日");
+    EXPECT_EQ(rollingChart.labels.size(), rolling.totals[0].size());
+
+    // 父分类的比较含子分类的支出
+    auto snack = std::make_shared<Category>();
+    snack->setName("Snack");
+    snack->setParentId(food->getId());
+    user->addCategory(snack);
+    auto treat = Record::create();
+    treat->setCategoryId(snack->getId());
+    treat->setAmount(5.0);
+    treat->setDateTime(QDateTime(QDate(2024, 3, 5), QTime(15, 0)));
+    user->addRecord(treat);
+    auto rolledUp = ReportService::computeCategoryComparison(*user->snapshot(), QDate(2024, 3, 1), QDate(2024, 3, 10));
+    ASSERT_EQ(rolledUp.size(), 3);
+    EXPECT_EQ(rolledUp[0].label, "Food");
+    EXPECT_DOUBLE_EQ(rolledUp[0].current, 25.0);
+    EXPECT_DOUBLE_EQ(rolledUp[0].previousMonth, 20.0);
+    EXPECT_EQ(rolledUp[1].label, "Food > Snack");
+    EXPECT_DOUBLE_EQ(rolledUp[1].current, 5.0);
+    EXPECT_DOUBLE_EQ(rolledUp[1].previousMonth, 0.0);
+}
+
+// 第十七组：按分类 × 月份维护的金额分位数草图
+TEST(IntegrationTest, ReportServiceAmountQuantiles) {
+    auto user = std::make_shared<User>("user_016", "Quantile User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    auto lunch = std::make_shared<Category>();
+    lunch->setName("Lunch");
+    lunch->setParentId(food->getId());
+    user->addCategory(lunch);
+
+    ReportService reportService(user);
+    QVector<std::shared_ptr<Record>> records;
+    for (int day = 0; day < 90; ++day) {
+        auto record = Record::create();
+        record->setCategoryId(day % 3 == 0 ? food->getId() : lunch->getId());
+        record->setAmount(1.0 + (day * 37) % 90);
+        record->setDateTime(QDateTime(QDate(2024, 1, 1).addDays(day), QTime(12, 0)));
+        records.append(record);
+    }
+    user->addRecords(records);
+
+    // 数据量小于草图容量时与排序后按最近秩取值的结果一致
+    auto exactQuantile = [&](const QDate& from, const QDate& to, const QString& categoryId, double q) {
+        QVector<double> amounts;
+        for (const auto& record : records) {
+            if (user->getRecord(record->getId()) && record->getDate() >= from && record->getDate() <= to
+                && (categoryId.isEmpty() || record->getCategoryId() == categoryId)) {
+                amounts.append(record->getAmount());
+            }
+        }
+        std::sort(amounts.begin(), amounts.end());
+        int rank = std::max(1, int(std::ceil(q * amounts.size())));
+        return amounts.isEmpty() ? 0.0 : amounts[rank - 1];
+    };
+
+    QVector<QPair<QDate, QDate>> ranges = {
+        {QDate(2024, 1, 1), QDate(2024, 3, 31)},
+        {QDate(2024, 1, 10), QDate(2024, 3, 5)},
+        {QDate(2024, 2, 3), QDate(2024, 2, 20)}
+    };
+    for (const auto& range : ranges) {
+        auto all = reportService.getAmountQuantiles(Record::Type::Expense, range.first, range.second);
+        // 记录到 2024-03-30 为止，每天一笔
+        EXPECT_EQ(all.count, quint64(range.first.daysTo(std::min(range.second, QDate(2024, 3, 30))) + 1));
+        EXPECT_EQ(all.median, exactQuantile(range.first, range.second, QString(), 0.5));
+        EXPECT_EQ(all.p90, exactQuantile(range.first, range.second, QString(), 0.9));
+        EXPECT_EQ(all.p99, exactQuantile(range.first, range.second, QString(), 0.99));
+        auto perCategory = reportService.getCategoryAmountQuantiles(Record::Type::Expense, range.first, range.second);
+        EXPECT_EQ(perCategory.value("Food > Lunch").median,
+                  exactQuantile(range.first, range.second, lunch->getId(), 0.5));
+    }
+    // 父分类包含子分类
+    EXPECT_EQ(reportService.getAmountQuantiles(Record::Type::Expense, QDate(2024, 1, 1), QDate(2024, 3, 31),
+                                               food->getId()).count, 90u);
+
+    // 删除、修改记录后受影响的草图从快照重建
+    Record before = *records[5];
+    records[5]->setAmount(1000.0);
+    user->updateRecord(records[5], before);
+    for (int i = 0; i < 10; ++i) {
+        user->removeRecord(records[i * 2]->getId());
+    }
+    auto january = reportService.getAmountQuantiles(Record::Type::Expense, QDate(2024, 1, 1), QDate(2024, 1, 31));
+    EXPECT_EQ(january.count, 21u);
+    EXPECT_EQ(january.median, exactQuantile(QDate(2024, 1, 1), QDate(2024, 1, 31), QString(), 0.5));
+    EXPECT_EQ(january.p99, 1000.0);
+}
+
+// 第十八组：支出去向排行（精确分组与 Space-Saving 近似统计）
+TEST(IntegrationTest, ReportServiceTopDestinations) {
+    auto user = std::make_shared<User>("user_017", "Destination User");
+    QVector<std::shared_ptr<Record>> records;
+    // 三个常去的商户（备注大小写、空白不统一）和大量只出现一次的备注
+    QStringList frequent = {"Coffee Shop", "  coffee   shop", "Supermarket", "SUPERMARKET ", "Gym"};
+    QVector<double> frequentAmounts = {20.0, 20.0, 15.0, 15.0, 10.0};
+    for (int i = 0; i < 3000; ++i) {
+        auto record = Record::create();
+        if (i % 3 == 0) {
+            record->setNote(frequent[(i / 3) % frequent.size()]);
+            record->setAmount(frequentAmounts[(i / 3) % frequent.size()]);
+        } else {
+            record->setNote(QString("一次性消费%1").arg(i));
+            record->setAmount(1.0 + i % 7);
+        }
+        record->setDateTime(QDateTime(QDate(2024, 1, 1).addDays(i % 60), QTime(12, 0)));
+        records.append(record);
+    }
+    auto blank = Record::create();
+    blank->setNote("   ");
+    blank->setAmount(5000.0);
+    blank->setDateTime(QDateTime(QDate(2024, 1, 5), QTime(8, 0)));
+    records.append(blank);
+    user->addRecords(records);
+
+    ReportService reportService(user);
+    auto exact = reportService.getTopSpendingDestinations(QDate(2024, 1, 1), QDate(2024, 2, 29), 3);
+    ASSERT_EQ(exact.size(), 3);
+    // 规范化后相同的备注合为一项，显示首次出现的写法；只有空白的备注不计入
+    EXPECT_EQ(exact[0].note, "Coffee Shop");
+    EXPECT_DOUBLE_EQ(exact[0].amount, 8000.0);
+    EXPECT_EQ(exact[1].note, "Supermarket");
+    EXPECT_DOUBLE_EQ(exact[1].amount, 6000.0);
+    EXPECT_EQ(exact[2].note, "Gym");
+    EXPECT_DOUBLE_EQ(exact[2].amount, 2000.0);
+    EXPECT_DOUBLE_EQ(exact[0].error, 0.0);
+
+    // 强制使用近似统计：排行一致，真实金额在误差范围内
+    auto approximate = ReportService::computeTopDestinations(*user->snapshot(), QDate(2024, 1, 1),
+                                                             QDate(2024, 2, 29), 3, 0);
+    ASSERT_EQ(approximate.size(), 3);
+    QStringList approximateNotes;
+    for (const auto& destination : approximate) {
+        approximateNotes.append(destination.note);
+    }
+    for (const auto& destination : exact) {
+        ASSERT_TRUE(approximateNotes.contains(destination.note));
+        const auto& estimate = approximate[approximateNotes.indexOf(destination.note)];
+        EXPECT_GE(estimate.amount, destination.amount);
+        EXPECT_LE(estimate.amount - estimate.error, destination.amount);
+    }
+    // 不同去向超过上限时放弃精确分组，结果与近似统计一致；上限足够时与精确结果一致
+    auto overflow = ReportService::computeTopDestinations(*user->snapshot(), QDate(2024, 1, 1),
+                                                          QDate(2024, 2, 29), 3, 100);
+    ASSERT_EQ(overflow.size(), approximate.size());
+    for (int i = 0; i < overflow.size(); ++i) {
+        EXPECT_EQ(overflow[i].note, approximate[i].note);
+        EXPECT_DOUBLE_EQ(overflow[i].amount, approximate[i].amount);
+    }
+    auto bounded = ReportService::computeTopDestinations(*user->snapshot(), QDate(2024, 1, 1),
+                                                         QDate(2024, 2, 29), 3, 2003);
+    ASSERT_EQ(bounded.size(), 3);
+    EXPECT_EQ(bounded[0].note, "Coffee Shop");
+    EXPECT_DOUBLE_EQ(bounded[0].amount, 8000.0);
+    EXPECT_DOUBLE_EQ(bounded[0].error, 0.0);
+
+    auto chart = reportService.generateChartData(ReportService::ReportType::TopDestinations,
+                                                 ReportService::TimeDimension::Daily,
+                                                 QDate(2024, 1, 1), QDate(2024, 2, 29));
+    ASSERT_GE(chart.labels.size(), 3);
+    EXPECT_EQ(chart.labels[2], "Gym");
+}
+
+// 第十九组：预算周期末支出预测与预计超支提醒
+TEST(IntegrationTest, ReportServiceBudgetForecast) {
+    auto user = std::make_shared<User>("user_018", "Forecast User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    auto lunch = std::make_shared<Category>();
+    lunch->setName("Lunch");
+    lunch->setParentId(food->getId());
+    user->addCategory(lunch);
+
+    // 周期从9天前到20天后，之前每天午餐10元
+    QDate today = QDate::currentDate();
+    auto budget = std::make_shared<Budget>();
+    budget->setCategoryId(food->getId());
+    budget->setTotalAmount(250.0);
+    budget->setPeriod(Budget::Period::Monthly);
+    budget->setStartDate(today.addDays(-9));
+    budget->setEndDate(today.addDays(20));
+    user->addBudget(budget);
+
+    auto addLunch = [&](const QDate& day, double amount) {
+        auto record = Record::create();
+        record->setCategoryId(lunch->getId());
+        record->setAmount(amount);
+        record->setDateTime(QDateTime(day, QTime(12, 0)));
+        user->addRecord(record);
+        return record;
+    };
+    for (int day = -9; day <= 0; ++day) {
+        addLunch(today.addDays(day), 10.0);
+    }
+
+    ReportService reportService(user);
+    auto forecasts = reportService.getBudgetForecasts(today);
+    ASSERT_EQ(forecasts.size(), 1);
+    EXPECT_DOUBLE_EQ(forecasts[0].spent, 100.0);
+    EXPECT_NEAR(forecasts[0].projected, 300.0, 1e-6);
+    EXPECT_TRUE(forecasts[0].willExceed());
+
+    // 增量更新（当天新增、补录更早的记录）与重新拟合的结果一致
+    addLunch(today, 50.0);
+    addLunch(today.addDays(-3), 30.0);
+    auto incremental = reportService.getBudgetForecast(budget, today);
+    ReportService refitted(user);
+    auto fresh = refitted.getBudgetForecast(budget, today);
+    EXPECT_DOUBLE_EQ(incremental.spent, 180.0);
+    EXPECT_NEAR(incremental.projected, fresh.projected, 1e-9);
+    EXPECT_GT(incremental.projected, forecasts[0].projected);
+
+    // 预计超支但尚未超支时提醒一次
+    ReminderService reminderService(user);
+    reminderService.checkBudgetForecast(incremental);
+    reminderService.checkBudgetForecast(incremental);
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 1);
+    EXPECT_EQ(reminders[0].type, ReminderService::ReminderType::BudgetForecastOver);
+    ReportService::BudgetForecast withinBudget = incremental;
+    withinBudget.budgetId = "other";
+    withinBudget.projected = withinBudget.budgeted - 1.0;
+    reminderService.checkBudgetForecast(withinBudget);
+    EXPECT_EQ(reminderService.getAllReminders().size(), 1);
+
+    // 进入新周期后重新提醒
+    ReportService::BudgetForecast nextPeriod = incremental;
+    nextPeriod.startDate = incremental.endDate.addDays(1);
+    reminderService.checkBudgetForecast(nextPeriod);
+    EXPECT_EQ(reminderService.getAllReminders().size(), 2);
+
+    // 未来日期的记录按今天计入，今天之后的日子仍被预测
+    addLunch(today.addDays(5), 20.0);
+    auto withFuture = reportService.getBudgetForecast(budget, today);
+    ReportService refittedWithFuture(user);
+    EXPECT_DOUBLE_EQ(withFuture.spent, 200.0);
+    EXPECT_NEAR(withFuture.projected, refittedWithFuture.getBudgetForecast(budget, today).projected, 1e-9);
+    EXPECT_NEAR(withFuture.projected, incremental.projected + 20.0, 1e-9);
+
+    // 未设置起止日期的预算与 User 的周期判断一致，视为覆盖今天；没有剩余日子可预测
+    auto openEnded = std::make_shared<Budget>();
+    openEnded->setCategoryId(lunch->getId());
+    openEnded->setTotalAmount(1000.0);
+    user->addBudget(openEnded);
+    auto withOpenEnded = reportService.getBudgetForecasts(today);
+    ASSERT_EQ(withOpenEnded.size(), 2);
+    auto openForecast = reportService.getBudgetForecast(openEnded, today);
+    EXPECT_DOUBLE_EQ(openForecast.spent, openEnded->getUsedAmount());
+    EXPECT_DOUBLE_EQ(openForecast.projected, openForecast.spent);
+}
+
+// 第二十组：新增与批量导入记录时的金额异常提醒
+TEST(IntegrationTest, ReminderServiceAmountAnomaly) {
+    auto user = std::make_shared<User>("user_019", "Anomaly User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    ReminderService reminderService(user);
+    reminderService.setBudgetAlertEnabled(false);
+
+    auto makeRecord = [&](double amount, int day) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(amount);
+        record->setDateTime(QDateTime(QDate(2024, 1, 1).addDays(day), QTime(12, 0)));
+        return record;
+    };
+
+    // 批量导入历史记录建立画像，正常金额不提醒
+    QVector<std::shared_ptr<Record>> history;
+    for (int day = 0; day < 60; ++day) {
+        history.append(makeRecord(30.0 + day % 7, day));
+    }
+    user->addRecords(history);
+    EXPECT_TRUE(reminderService.getAllReminders().isEmpty());
+
+    // 逐笔新增的异常金额立即提醒
+    user->addRecord(makeRecord(35.0, 60));
+    user->addRecord(makeRecord(900.0, 61));
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 1);
+    EXPECT_EQ(reminders[0].type, ReminderService::ReminderType::AmountAnomaly);
+
+    // 批量导入多笔异常时合并为一条
+    QVector<std::shared_ptr<Record>> imported;
+    for (int i = 0; i < 5; ++i) {
+        imported.append(makeRecord(800.0 + i * 100, 62 + i));
+    }
+    user->addRecords(imported);
+    reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 2);
+    EXPECT_TRUE(reminders[1].message.contains("5"));
+
+    // 画像属于账本，可复制到恢复的用户上
+    auto restored = std::make_shared<User>("user_019", "Anomaly User");
+    restored->setAnomalyDetector(user->getAnomalyDetector());
+    EXPECT_EQ(restored->getAnomalyDetector().profiles().size(), 1);
+
+    reminderService.setAnomalyAlertEnabled(false);
+    user->addRecord(makeRecord(5000.0, 70));
+    EXPECT_EQ(reminderService.getAllReminders().size(), 2);
+}
+
+// 第二十一组：预算阈值由数据变更驱动，每个周期每个级别只提醒一次
+TEST(IntegrationTest, ReminderServiceBudgetThresholdOncePerPeriod) {
+    auto user = std::make_shared<User>("user_020", "Threshold User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    ReminderService reminderService(user);
+    reminderService.setAnomalyAlertEnabled(false);
+
+    QDate today = QDate::currentDate();
+    auto budget = Budget::create();
+    budget->setCategoryId(food->getId());
+    budget->setTotalAmount(1000.0);
+    budget->setStartDate(today.addDays(-10));
+    budget->setEndDate(today.addDays(10));
+    user->addBudget(budget);
+
+    auto addExpense = [&](double amount) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(amount);
+        record->setDateTime(QDateTime(today, QTime(12, 0)));
+        user->addRecord(record);
+        return record;
+    };
+
+    addExpense(500.0);
+    EXPECT_TRUE(reminderService.getAllReminders().isEmpty());
+
+    // 越过警告阈值提醒一次，继续增加不重复提醒
+    addExpense(350.0);
+    addExpense(50.0);
+    reminderService.checkBudgetStatus();
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 1);
+    EXPECT_EQ(reminders[0].type, ReminderService::ReminderType::BudgetWarning);
+
+    // 超支时提醒一次，删除记录回落后再次超支不重复提醒
+    auto big = addExpense(200.0);
+    user->removeRecord(big->getId());
+    addExpense(150.0);
+    addExpense(10.0);
+    reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 2);
+    EXPECT_EQ(reminders[1].type, ReminderService::ReminderType::BudgetOver);
+
+    // 进入新周期后重新提醒
+    budget->setStartDate(today.addDays(-1));
+    user->updateBudget(budget);
+    budget->setStartDate(today.addDays(-10));
+    user->updateBudget(budget);
+    EXPECT_EQ(reminderService.getAllReminders().size(), 4);
+
+    // 删除预算后不再提醒
+    user->removeBudget(budget->getId());
+    addExpense(100.0);
+    EXPECT_EQ(reminderService.getAllReminders().size(), 4);
+}
+
+// 第二十二组：账单与定期报告的定时提醒
+TEST(IntegrationTest, ReminderServiceScheduledReminders) {
+    auto user = std::make_shared<User>("user_021", "Schedule User");
+    ReminderService reminderService(user);
+    
+    // 超过 24 天的报告周期不再溢出
+    reminderService.setReportPeriod(45);
+    auto scheduled = reminderService.getScheduledReminders();
+    ASSERT_EQ(scheduled.size(), 1);
+    EXPECT_EQ(scheduled[0].id, ReminderService::kPeriodicReportId);
+    EXPECT_EQ(QDate::currentDate().daysTo(scheduled[0].dueTime.date()), 45);
+    reminderService.setPeriodicReportEnabled(false);
+    EXPECT_TRUE(reminderService.getScheduledReminders().isEmpty());
+    
+    // 每月账单从首次到期日推算，月末日期不漂移
+    QDateTime rentDue(QDate(2024, 1, 31), QTime(9, 0));
+    QString rentId = reminderService.scheduleBillReminder("房租", "本月房租到期", rentDue, 1);
+    QString cardId = reminderService.scheduleBillReminder("信用卡", "信用卡还款日", QDateTime(QDate(2024, 2, 10), QTime(9, 0)));
+    for (int i = 0; i < 1000; ++i) {
+        reminderService.scheduleBillReminder("账单", "远期账单", QDateTime(QDate(2030, 1, 1).addDays(i), QTime(9, 0)));
+    }
+    
+    reminderService.processDueReminders(QDateTime(QDate(2024, 1, 30), QTime(12, 0)));
+    EXPECT_TRUE(reminderService.getAllReminders().isEmpty());
+    
+    reminderService.processDueReminders(QDateTime(QDate(2024, 2, 1), QTime(12, 0)));
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 1);
+    EXPECT_EQ(reminders[0].type, ReminderService::ReminderType::BillReminder);
+    EXPECT_EQ(reminders[0].title, QString("房租"));
+    
+    // 停机期间错过的多次重复只补发一次，下次到期仍为月末
+    reminderService.processDueReminders(QDateTime(QDate(2024, 4, 15), QTime(12, 0)));
+    EXPECT_EQ(reminderService.getAllReminders().size(), 3);
+    scheduled = reminderService.getScheduledReminders();
+    ASSERT_EQ(scheduled.size(), 1001);
+    EXPECT_EQ(scheduled[0].id, rentId);
+    EXPECT_EQ(scheduled[0].dueTime.date(), QDate(2024, 4, 30));
+    
+    // 恢复保存的计划后继续按时提醒
+    ReminderService restored(user);
+    restored.setPeriodicReportEnabled(false);
+    restored.restoreScheduledReminders(scheduled);
+    EXPECT_EQ(restored.getScheduledReminders().size(), 1001);
+    restored.cancelScheduledReminder(rentId);
+    restored.processDueReminders(QDateTime(QDate(2030, 1, 10), QTime(12, 0)));
+    EXPECT_EQ(restored.getAllReminders().size(), 10);
+    EXPECT_EQ(restored.getScheduledReminders().size(), 990);
+    EXPECT_FALSE(cardId.isEmpty());
+}
+
+// 第二十三组：未读计数与有界提醒缓冲
+TEST(IntegrationTest, ReminderServiceBoundedReminderStore) {
+    auto user = std::make_shared<User>("user_022", "Store User");
+    ReminderService reminderService(user);
+    reminderService.setPeriodicReportEnabled(false);
+    
+    const int total = ReminderService::kMaxReminders + 100;
+    QDateTime due(QDate(2024, 1, 1), QTime(9, 0));
+    for (int i = 0; i < total; ++i) {
+        reminderService.scheduleBillReminder(QString("账单%1").arg(i), "到期", due.addSecs(i));
+    }
+    reminderService.processDueReminders(due.addDays(1));
+    
+    // 超出容量的最早提醒被移出
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), ReminderService::kMaxReminders);
+    EXPECT_EQ(reminders.first().title, QString("账单100"));
+    EXPECT_EQ(reminders.last().title, QString("账单%1").arg(total - 1));
+    EXPECT_EQ(reminderService.getUnreadCount(), ReminderService::kMaxReminders);
+    
+    reminderService.markReminderAsRead(reminders[0].id);
+    reminderService.markReminderAsRead(reminders[0].id);
+    reminderService.clearReminder(reminders[1].id);
+    reminderService.clearReminder(reminders[10].id);
+    EXPECT_EQ(reminderService.getUnreadCount(), ReminderService::kMaxReminders - 3);
+    EXPECT_EQ(reminderService.getUnreadReminders().size(), ReminderService::kMaxReminders - 3);
+    
+    // 清除中间的提醒后空槽随最早的提醒一起回收
+    reminderService.scheduleBillReminder("新账单", "到期", due);
+    reminderService.processDueReminders(due.addDays(1));
+    reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), ReminderService::kMaxReminders - 2);
+    EXPECT_EQ(reminders.first().title, QString("账单102"));
+    EXPECT_EQ(reminders.last().title, QString("新账单"));
+    EXPECT_EQ(reminderService.getUnreadCount(), ReminderService::kMaxReminders - 2);
+    
+    reminderService.markAllRemindersAsRead();
+    EXPECT_EQ(reminderService.getUnreadCount(), 0);
+    EXPECT_TRUE(reminderService.getUnreadReminders().isEmpty());
+    reminderService.clearAllReminders();
+    EXPECT_TRUE(reminderService.getAllReminders().isEmpty());
+}
+
+// 第二十四组：移出内存的提醒归档到存储并可按顺序读回
+TEST(IntegrationTest, DataStorageReminderArchive) {
+    QDir dir(QDir::temp().filePath("ledger_archive_test"));
+    dir.removeRecursively();
+    DataStorageService storageService;
+    ASSERT_TRUE(storageService.initialize(dir.path()));
+    EXPECT_TRUE(storageService.loadArchivedReminders("user_023").isEmpty());
+
+    auto user = std::make_shared<User>("user_023", "Archive User");
+    ReminderService reminderService(user);
+    reminderService.setPeriodicReportEnabled(false);
+    QDateTime due(QDate(2024, 1, 1), QTime(9, 0));
+    for (int i = 0; i < 3; ++i) {
+        reminderService.scheduleBillReminder(QString("账单%1").arg(i), "到期", due.addSecs(i));
+    }
+    reminderService.processDueReminders(due.addDays(1));
+    auto reminders = reminderService.getAllReminders();
+    ASSERT_EQ(reminders.size(), 3);
+    reminderService.markReminderAsRead(reminders[1].id);
+    reminders = reminderService.getAllReminders();
+    for (const auto& reminder : reminders) {
+        ASSERT_TRUE(storageService.archiveReminder(reminder, user->getId()));
+    }
+    EXPECT_FALSE(storageService.archiveReminder(ReminderService::Reminder(), user->getId()));
+
+    // 写入中断留下的半行在读取时跳过
+    QFile file(QDir(dir.filePath(user->getId())).filePath("reminders_archive.jsonl"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("{\"id\":\"broken");
+    file.close();
+
+    auto archived = storageService.loadArchivedReminders(user->getId());
+    ASSERT_EQ(archived.size(), 3);
+    for (int i = 0; i < archived.size(); ++i) {
+        EXPECT_EQ(archived[i].id, reminders[i].id);
+        EXPECT_EQ(archived[i].type, ReminderService::ReminderType::BillReminder);
+        EXPECT_EQ(archived[i].title, reminders[i].title);
+        EXPECT_EQ(archived[i].message, reminders[i].message);
+        EXPECT_EQ(archived[i].timestamp, reminders[i].timestamp);
+        EXPECT_EQ(archived[i].isRead, reminders[i].isRead);
+        EXPECT_EQ(archived[i].data.toString(), reminders[i].data.toString());
+    }
+    EXPECT_TRUE(archived[1].isRead);
+    EXPECT_TRUE(storageService.loadArchivedReminders("user_other").isEmpty());
+    dir.removeRecursively();
+}
+
+// 第二十五组：定时提醒计划经存储保存后恢复，重复项继续按首次到期日推算
+TEST(IntegrationTest, DataStorageScheduledRemindersRoundTrip) {
+    QDir dir(QDir::temp().filePath("ledger_schedule_test"));
+    dir.removeRecursively();
+    DataStorageService storageService;
+    ASSERT_TRUE(storageService.initialize(dir.path()));
+    EXPECT_TRUE(storageService.loadScheduledReminders("user_024").isEmpty());
+
+    auto user = std::make_shared<User>("user_024", "Schedule Storage User");
+    ReminderService reminderService(user);
+    reminderService.setReportPeriod(30);
+    QString rentId = reminderService.scheduleBillReminder("房租", "本月房租到期", QDateTime(QDate(2024, 1, 31), QTime(9, 0)), 1);
+    QString cardId = reminderService.scheduleBillReminder("信用卡", "信用卡还款日", QDateTime(QDate(2024, 6, 10), QTime(9, 0)));
+    reminderService.processDueReminders(QDateTime(QDate(2024, 3, 1), QTime(12, 0)));
+
+    auto scheduled = reminderService.getScheduledReminders();
+    ASSERT_EQ(scheduled.size(), 3);
+    ASSERT_TRUE(storageService.saveScheduledReminders(scheduled, user->getId()));
+
+    auto loaded = storageService.loadScheduledReminders(user->getId());
+    ASSERT_EQ(loaded.size(), scheduled.size());
+    for (int i = 0; i < loaded.size(); ++i) {
+        EXPECT_EQ(loaded[i].id, scheduled[i].id);
+        EXPECT_EQ(loaded[i].type, scheduled[i].type);
+        EXPECT_EQ(loaded[i].title, scheduled[i].title);
+        EXPECT_EQ(loaded[i].message, scheduled[i].message);
+        EXPECT_EQ(loaded[i].dueTime, scheduled[i].dueTime);
+        EXPECT_EQ(loaded[i].firstDueTime, scheduled[i].firstDueTime);
+        EXPECT_EQ(loaded[i].occurrence, scheduled[i].occurrence);
+        EXPECT_EQ(loaded[i].repeatDays, scheduled[i].repeatDays);
+        EXPECT_EQ(loaded[i].repeatMonths, scheduled[i].repeatMonths);
+    }
+
+    // 恢复后的账单仍在月末到期，一次性账单到期后移出计划
+    ReminderService restored(user);
+    restored.restoreScheduledReminders(loaded);
+    restored.processDueReminders(QDateTime(QDate(2024, 6, 15), QTime(12, 0)));
+    QStringList titles;
+    for (const auto& reminder : restored.getAllReminders()) {
+        titles.append(reminder.title);
+    }
+    EXPECT_TRUE(titles.contains("房租"));
+    EXPECT_TRUE(titles.contains("信用卡"));
+    bool rentFound = false;
+    for (const auto& reminder : restored.getScheduledReminders()) {
+        EXPECT_NE(reminder.id, cardId);
+        if (reminder.id == rentId) {
+            rentFound = true;
+            EXPECT_EQ(reminder.dueTime.date(), QDate(2024, 6, 30));
+        }
+    }
+    EXPECT_TRUE(rentFound);
+
+    // 重新保存覆盖旧计划
+    ASSERT_TRUE(storageService.saveScheduledReminders({}, user->getId()));
+    EXPECT_TRUE(storageService.loadScheduledReminders(user->getId()).isEmpty());
+    dir.removeRecursively();
+}
+
+// 第二十六组：删除和修改记录时撤销原金额，金额画像经存储保存后恢复
+TEST(IntegrationTest, DataStorageAnomalyDetectorRoundTrip) {
+    auto user = std::make_shared<User>("user_025", "Detector User");
+    auto food = std::make_shared<Category>();
+    food->setName("Food");
+    user->addCategory(food);
+    const auto key = AmountAnomalyDetector::keyFor(Record::Type::Expense, food->getId());
+
+    auto makeRecord = [&](double amount) {
+        auto record = Record::create();
+        record->setCategoryId(food->getId());
+        record->setAmount(amount);
+        record->setDateTime(QDateTime(QDate(2024, 1, 1), QTime(12, 0)));
+        return record;
+    };
+
+    // 预热阶段误录的大额删除后不再影响画像
+    QVector<std::shared_ptr<Record>> records;
+    for (int i = 0; i < 10; ++i) {
+        records.append(makeRecord(30.0 + i % 3));
+    }
+    user->addRecords(records);
+    auto typo = makeRecord(30000.0);
+    user->addRecord(typo);
+    user->removeRecord(typo->getId());
+    auto profile = user->getAnomalyDetector().profiles().value(key);
+    EXPECT_EQ(profile.count, quint64(10));
+    EXPECT_LT(profile.mean, 40.0);
+
+    // 修改金额时以新金额替换原金额
+    Record before = *records[0];
+    records[0]->setAmount(35.0);
+    user->updateRecord(records[0], before);
+    profile = user->getAnomalyDetector().profiles().value(key);
+    EXPECT_EQ(profile.count, quint64(10));
+    EXPECT_TRUE(profile.warmup.contains(35.0));
+    user->removeRecords({records[1]->getId(), records[2]->getId()});
+    EXPECT_EQ(user->getAnomalyDetector().profiles().value(key).count, quint64(8));
+
+    for (int i = 0; i < 20; ++i) {
+        user->addRecord(makeRecord(30.0 + i % 3));
+    }
+    AmountAnomalyDetector detector = user->getAnomalyDetector();
+    detector.setThreshold(4.0);
+
+    QDir dir(QDir::temp().filePath("ledger_detector_test"));
+    dir.removeRecursively();
+    DataStorageService storageService;
+    ASSERT_TRUE(storageService.initialize(dir.path()));
+    EXPECT_TRUE(storageService.loadAnomalyDetector(user->getId()).profiles().isEmpty());
+    ASSERT_TRUE(storageService.saveAnomalyDetector(detector, user->getId()));
+
+    auto restored = std::make_shared<User>("user_025", "Detector User");
+    restored->setAnomalyDetector(storageService.loadAnomalyDetector(user->getId()));
+    const auto& loaded = restored->getAnomalyDetector();
+    EXPECT_DOUBLE_EQ(loaded.threshold(), 4.0);
+    ASSERT_EQ(loaded.profiles().size(), 1);
+    const auto& saved = detector.profiles().value(key);
+    const auto& read = loaded.profiles().value(key);
+    EXPECT_EQ(read.count, saved.count);
+    EXPECT_DOUBLE_EQ(read.mean, saved.mean);
+    EXPECT_DOUBLE_EQ(read.m2, saved.m2);
+    EXPECT_DOUBLE_EQ(read.median, saved.median);
+    EXPECT_DOUBLE_EQ(read.mad, saved.mad);
+    EXPECT_EQ(read.warmup, saved.warmup);
+    EXPECT_EQ(loaded.evaluate(Record::Type::Expense, food->getId(), 900.0).anomalous,
+              detector.evaluate(Record::Type::Expense, food->getId(), 900.0).anomalous);
+    EXPECT_TRUE(loaded.evaluate(Record::Type::Expense, food->getId(), 900.0).anomalous);
+    dir.removeRecursively();
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -10,6 +10,7 @@
 #include <QLabel>
 #include <QStatusBar>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -36,9 +37,12 @@ void MainWindow::setupUI() {
     m_centralStack = new QStackedWidget(this);
     setCentralWidget(m_centralStack);
     
+    // 报告服务由统计界面和提醒服务共用，数据变更时只增量维护一份报告索引
+    m_reportService = std::make_shared<ReportService>(m_currentUser);
+    
     // 创建各个功能界面
     m_transactionWidget = new TransactionWidget(m_currentUser, this);
-    m_statisticsWidget = new StatisticsWidget(m_currentUser, this);
+    m_statisticsWidget = new StatisticsWidget(m_currentUser, m_reportService, this);
     m_budgetWidget = new BudgetWidget(m_currentUser, this);
     m_settingsWidget = new SettingsWidget(m_currentUser, this);
     
@@ -119,27 +123,24 @@ void MainWindow::createStatusBar() {
 }
 
 void MainWindow::initializeServices() {
-    // 创建报告服务
-    m_reportService = std::make_shared<ReportService>(m_currentUser);
-    
     // 创建提醒服务
     m_reminderService = std::make_shared<ReminderService>(m_currentUser);
     connect(m_reminderService.get(), &ReminderService::budgetWarning, 
             this, &MainWindow::onBudgetWarning);
     connect(m_reminderService.get(), &ReminderService::budgetOver, 
             this, &MainWindow::onBudgetOver);
+    connect(m_reminderService.get(), &ReminderService::budgetForecastOver,
+            this, &MainWindow::onBudgetForecastOver);
+    m_reminderService->setReportService(m_reportService);
+    connect(m_reminderService.get(), &ReminderService::amountAnomaly,
+            this, &MainWindow::onAmountAnomaly);
     connect(m_reminderService.get(), &ReminderService::unreadCountChanged, 
             this, &MainWindow::onUnreadRemindersChanged);
 
-    // 如果交易或预算发生变化，立即检查预算状态
+    // 预算检查与预算视图刷新通过 User 的变更事件增量完成
     if (m_transactionWidget) {
-    connect(m_transactionWidget, &TransactionWidget::recordsChanged,
-        m_reminderService.get(), &ReminderService::checkBudgetStatus);
-    // also update balance display and refresh budget view when transactions change
     connect(m_transactionWidget, &TransactionWidget::recordsChanged,
         this, &MainWindow::updateBalanceDisplay);
-    connect(m_transactionWidget, &TransactionWidget::recordsChanged,
-        m_budgetWidget, &BudgetWidget::refreshData);
     }
     if (m_budgetWidget) {
     connect(m_budgetWidget, &BudgetWidget::budgetWarning, this, &MainWindow::onBudgetWarning);
@@ -148,29 +149,37 @@ void MainWindow::initializeServices() {
     
     // 创建数据存储服务
     m_dataService = std::make_shared<DataStorageService>();
+    m_dataService->initialize(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    connect(m_reminderService.get(), &ReminderService::reminderArchived,
+            this, &MainWindow::onReminderArchived);
+    // 恢复上次保存的定时提醒，停机期间已到期的项在启动时补发
+    m_reminderService->restoreScheduledReminders(m_dataService->loadScheduledReminders(m_currentUser->getId()));
     
     // 启动提醒服务
     m_reminderService->start();
 }
 
 void MainWindow::loadUserData() {
+    // 恢复金额异常检测画像
+    m_currentUser->setAnomalyDetector(m_dataService->loadAnomalyDetector(m_currentUser->getId()));
+    
     // 这里可以从数据库加载用户数据
     // 现在使用默认数据
     
     // 添加一些示例分类
-    auto foodCategory = std::make_shared<Category>();
+    auto foodCategory = Category::create();
     foodCategory->setName("餐饮");
     foodCategory->setIcon(":/icons/categories/food.png");
     foodCategory->setColor("#FF6B35");
     m_currentUser->addCategory(foodCategory);
     
-    auto transportCategory = std::make_shared<Category>();
+    auto transportCategory = Category::create();
     transportCategory->setName("交通");
     transportCategory->setIcon(":/icons/categories/transport.png");
     transportCategory->setColor("#4A90E2");
     m_currentUser->addCategory(transportCategory);
     
-    auto shoppingCategory = std::make_shared<Category>();
+    auto shoppingCategory = Category::create();
     shoppingCategory->setName("购物");
     shoppingCategory->setIcon(":/icons/categories/shopping.png");
     shoppingCategory->setColor("#9013FE");
@@ -184,6 +193,10 @@ void MainWindow::saveUserData() {
     // 保存用户数据到数据库
     if (m_dataService) {
         m_dataService->saveUser(m_currentUser);
+        m_dataService->saveAnomalyDetector(m_currentUser->getAnomalyDetector(), m_currentUser->getId());
+        if (m_reminderService) {
+            m_dataService->saveScheduledReminders(m_reminderService->getScheduledReminders(), m_currentUser->getId());
+        }
     }
 }
 
@@ -215,6 +228,25 @@ void MainWindow::onBudgetOver(const QString& categoryName, double overAmount) {
     m_statusLabel->setText(message);
 }
 
+void MainWindow::onBudgetForecastOver(const QString& categoryName, double projectedAmount, double budgetAmount) {
+    // 预测提醒只在状态栏提示，不弹出对话框
+    m_statusLabel->setText(QString("预计超支: %1 本周期预计支出 ¥%2，预算 ¥%3")
+                           .arg(categoryName)
+                           .arg(projectedAmount, 0, 'f', 2)
+                           .arg(budgetAmount, 0, 'f', 2));
+}
+
+void MainWindow::onAmountAnomaly(const QString& categoryName, double amount, double typicalAmount) {
+    m_statusLabel->setText(QString("金额异常: %1 ¥%2（通常约 ¥%3）")
+                           .arg(categoryName)
+                           .arg(amount, 0, 'f', 2)
+                           .arg(typicalAmount, 0, 'f', 2));
+}
+
+void MainWindow::onReminderArchived(const ReminderService::Reminder& reminder) {
+    m_dataService->archiveReminder(reminder, m_currentUser->getId());
+}
+
 void MainWindow::onUnreadRemindersChanged(int count) {
     m_reminderLabel->setText(QString("提醒: %1").arg(count));
     if (count > 0) {
@@ -31,6 +31,9 @@ private slots:
     void onNavigationTriggered(QAction* action);
     void onBudgetWarning(const QString& categoryName, double usedPercent);
     void onBudgetOver(const QString& categoryName, double overAmount);
+    void onBudgetForecastOver(const QString& categoryName, double projectedAmount, double budgetAmount);
+    void onAmountAnomaly(const QString& categoryName, double amount, double typicalAmount);
+    void onReminderArchived(const ReminderService::Reminder& reminder);
     void onUnreadRemindersChanged(int count);
     void showAboutDialog();
     void showHelpDialog();
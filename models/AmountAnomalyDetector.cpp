@@ -0,0 +1,135 @@
+#include "AmountAnomalyDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 正态分布下绝对中位差与标准差的换算系数
+constexpr double kMadToSigma = 1.4826;
+
+double medianOf(QVector<double> values) {
+    std::sort(values.begin(), values.end());
+    int middle = values.size() / 2;
+    return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+double signOf(double value) {
+    return value > 0.0 ? 1.0 : (value < 0.0 ? -1.0 : 0.0);
+}
+
+} // namespace
+
+AmountAnomalyDetector::AmountAnomalyDetector()
+    : m_threshold(kDefaultThreshold) {
+}
+
+QString AmountAnomalyDetector::keyFor(Record::Type type, const QString& categoryId) {
+    return QString::number(static_cast<int>(type)) + ":" + categoryId;
+}
+
+void AmountAnomalyDetector::setThreshold(double threshold) {
+    if (threshold > 0.0) {
+        m_threshold = threshold;
+    }
+}
+
+double AmountAnomalyDetector::spreadOf(const Profile& profile) {
+    double spread = std::max(kMadToSigma * profile.mad, kMinRelativeSpread * std::abs(profile.median));
+    return spread > 0.0 ? spread : std::sqrt(profile.variance());
+}
+
+AmountAnomalyDetector::Result AmountAnomalyDetector::evaluateProfile(const Profile& profile, double amount,
+                                                                     double threshold) {
+    Result result;
+    result.typicalAmount = profile.median;
+    if (profile.count < quint64(kWarmupCount)) {
+        return result;
+    }
+    double spread = spreadOf(profile);
+    if (spread <= 0.0) {
+        return result;
+    }
+    result.score = (amount - profile.median) / spread;
+    result.anomalous = result.score > threshold;
+    return result;
+}
+
+AmountAnomalyDetector::Result AmountAnomalyDetector::evaluate(Record::Type type, const QString& categoryId,
+                                                              double amount) const {
+    auto it = m_profiles.constFind(keyFor(type, categoryId));
+    if (it == m_profiles.constEnd()) {
+        return Result();
+    }
+    return evaluateProfile(it.value(), amount, m_threshold);
+}
+
+void AmountAnomalyDetector::initializeFromWarmup(Profile& profile) {
+    profile.median = medianOf(profile.warmup);
+    QVector<double> deviations;
+    deviations.reserve(profile.warmup.size());
+    for (double value : profile.warmup) {
+        deviations.append(std::abs(value - profile.median));
+    }
+    profile.mad = medianOf(deviations);
+    profile.warmup.clear();
+}
+
+AmountAnomalyDetector::Result AmountAnomalyDetector::observe(Record::Type type, const QString& categoryId,
+                                                             double amount) {
+    Profile& profile = m_profiles[keyFor(type, categoryId)];
+    Result result = evaluateProfile(profile, amount, m_threshold);
+    
+    ++profile.count;
+    double delta = amount - profile.mean;
+    profile.mean += delta / profile.count;
+    profile.m2 += delta * (amount - profile.mean);
+    
+    if (profile.count <= quint64(kWarmupCount)) {
+        // 预热阶段保存金额，满 kWarmupCount 笔时精确计算一次
+        profile.warmup.append(amount);
+        profile.median = medianOf(profile.warmup);
+        if (profile.count == quint64(kWarmupCount)) {
+            initializeFromWarmup(profile);
+        }
+        return result;
+    }
+    
+    // 按当前离散度的固定比例向新金额方向移动一步，异常值对估计的影响有界
+    double step = kLearningRate * spreadOf(profile);
+    profile.median += step * signOf(amount - profile.median);
+    profile.mad = std::max(0.0, profile.mad + step * signOf(std::abs(amount - profile.median) - profile.mad));
+    return result;
+}
+
+void AmountAnomalyDetector::forget(Record::Type type, const QString& categoryId, double amount) {
+    auto it = m_profiles.find(keyFor(type, categoryId));
+    if (it == m_profiles.end()) {
+        return;
+    }
+    Profile& profile = it.value();
+    
+    bool warmingUp = profile.count < quint64(kWarmupCount);
+    if (warmingUp) {
+        int index = profile.warmup.indexOf(amount);
+        if (index < 0) {
+            return;
+        }
+        profile.warmup.removeAt(index);
+    } else if (profile.count <= quint64(kWarmupCount)) {
+        return;
+    }
+    
+    // Welford 算法的逆运算
+    if (profile.count == 1) {
+        profile = Profile();
+    } else {
+        double mean = (profile.count * profile.mean - amount) / (profile.count - 1);
+        profile.m2 = std::max(0.0, profile.m2 - (amount - profile.mean) * (amount - mean));
+        profile.mean = mean;
+        --profile.count;
+    }
+    
+    if (warmingUp) {
+        profile.median = profile.warmup.isEmpty() ? 0.0 : medianOf(profile.warmup);
+    }
+}
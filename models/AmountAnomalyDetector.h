@@ -0,0 +1,67 @@
+#ifndef AMOUNTANOMALYDETECTOR_H
+#define AMOUNTANOMALYDETECTOR_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "Record.h"
+
+// 金额异常检测：按（收支类型，分类）在线维护金额画像，新金额先按已有画像计算稳健 z 分数
+// （偏离中位数的程度除以绝对中位差换算的离散度），再计入画像，每笔更新 O(1)
+class AmountAnomalyDetector {
+public:
+    // 一个分类的金额画像
+    struct Profile {
+        quint64 count = 0;
+        double mean = 0.0;          // Welford 算法维护的均值与离差平方和
+        double m2 = 0.0;
+        double median = 0.0;        // 中位数、绝对中位差的流式估计
+        double mad = 0.0;
+        QVector<double> warmup;     // 前 kWarmupCount 笔金额，用于精确初始化中位数和绝对中位差
+        
+        double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    };
+    
+    struct Result {
+        bool anomalous = false;
+        double score = 0.0;         // 稳健 z 分数，正数表示高于常见金额
+        double typicalAmount = 0.0; // 该分类金额的中位数
+    };
+    
+    // 画像中的金额不少于该笔数时才判断异常
+    static constexpr int kWarmupCount = 15;
+    static constexpr double kDefaultThreshold = 3.5;
+    
+    AmountAnomalyDetector();
+    
+    static QString keyFor(Record::Type type, const QString& categoryId);
+    
+    // 只提示金额明显偏大的记录
+    Result observe(Record::Type type, const QString& categoryId, double amount);
+    Result evaluate(Record::Type type, const QString& categoryId, double amount) const;
+    // 撤销一笔已计入的金额（删除或修改记录时）：预热阶段精确撤销；预热完成后只撤销均值和方差，
+    // 中位数与绝对中位差的流式估计无法回退（单笔金额对其影响不超过一步），笔数也不再回到预热阶段
+    void forget(Record::Type type, const QString& categoryId, double amount);
+    
+    double threshold() const { return m_threshold; }
+    void setThreshold(double threshold);
+    
+    // 画像随账本一起保存和恢复（见 DataStorageService::saveAnomalyDetector）
+    const QHash<QString, Profile>& profiles() const { return m_profiles; }
+    void setProfiles(const QHash<QString, Profile>& profiles) { m_profiles = profiles; }
+
+private:
+    // 流式估计每步的调整量占离散度的比例
+    static constexpr double kLearningRate = 0.05;
+    // 离散度下限占中位数的比例，避免金额固定的分类把微小变化判为异常
+    static constexpr double kMinRelativeSpread = 0.1;
+    
+    static double spreadOf(const Profile& profile);
+    static Result evaluateProfile(const Profile& profile, double amount, double threshold);
+    static void initializeFromWarmup(Profile& profile);
+    
+    QHash<QString, Profile> m_profiles;
+    double m_threshold;
+};
+
+#endif // AMOUNTANOMALYDETECTOR_H
@@ -1,4 +1,6 @@
 #include "Budget.h"
+#include "ObjectPool.h"
+#include <algorithm>
 
 Budget::Budget(const QString& id) 
     : m_id(id.isEmpty() ? QUuid::createUuid().toString() : id)
@@ -9,6 +11,23 @@ Budget::Budget(const QString& id)
     , m_status(Status::Created) {
 }
 
+std::shared_ptr<Budget> Budget::create(const QString& id) {
+    return makePooled<Budget>(id);
+}
+
+QString Budget::getPeriodString() const {
+    switch (m_period) {
+        case Period::Weekly:
+            return "周度";
+        case Period::Monthly:
+            return "月度";
+        case Period::Yearly:
+            return "年度";
+        default:
+            return "未知";
+    }
+}
+
 double Budget::getUsagePercentage() const {
     if (m_totalAmount <= 0) {
         return 0.0;
@@ -24,8 +43,9 @@ void Budget::addExpense(double amount) {
 }
 
 void Budget::removeExpense(double amount) {
-    if (amount > 0 && m_usedAmount >= amount) {
-        m_usedAmount -= amount;
+    if (amount > 0) {
+        // 浮点累计误差可能使差值略小于0
+        m_usedAmount = std::max(0.0, m_usedAmount - amount);
         checkAndUpdateStatus();
     }
 }
@@ -34,19 +54,21 @@ void Budget::resetForNewPeriod() {
     m_usedAmount = 0.0;
     m_status = Status::Active;
     
-    // 根据周期类型设置新的日期范围
+    // 根据周期类型设置当前自然周期的日期范围
     QDate currentDate = QDate::currentDate();
-    m_startDate = currentDate;
     
     switch (m_period) {
         case Period::Weekly:
-            m_endDate = currentDate.addDays(6);
+            m_startDate = currentDate.addDays(1 - currentDate.dayOfWeek());
+            m_endDate = m_startDate.addDays(6);
             break;
         case Period::Monthly:
+            m_startDate = QDate(currentDate.year(), currentDate.month(), 1);
             m_endDate = QDate(currentDate.year(), currentDate.month(), 
                             currentDate.daysInMonth());
             break;
         case Period::Yearly:
+            m_startDate = QDate(currentDate.year(), 1, 1);
             m_endDate = QDate(currentDate.year(), 12, 31);
             break;
     }
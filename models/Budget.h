@@ -4,6 +4,7 @@
 #include <QString>
 #include <QDate>
 #include <QUuid>
+#include <memory>
 
 class Budget {
 public:
@@ -22,6 +23,7 @@ public:
     };
     
     Budget(const QString& id = QUuid::createUuid().toString());
+    static std::shared_ptr<Budget> create(const QString& id = QUuid::createUuid().toString());
     
     // Getter和Setter
     QString getId() const { return m_id; }
@@ -50,6 +52,8 @@ public:
     Status getStatus() const { return m_status; }
     void setStatus(Status status) { m_status = status; }
     
+    QString getPeriodString() const;
+    
     // 状态管理
     double getUsagePercentage() const;
     bool isInWarning() const { return m_status == Status::Warning; }
@@ -1,4 +1,5 @@
 #include "Category.h"
+#include "ObjectPool.h"
 
 Category::Category(const QString& id) 
     : m_id(id.isEmpty() ? QUuid::createUuid().toString() : id)
@@ -6,6 +7,10 @@ Category::Category(const QString& id)
     , m_sortOrder(0) {
 }
 
+std::shared_ptr<Category> Category::create(const QString& id) {
+    return makePooled<Category>(id);
+}
+
 void Category::addSubCategory(const QString& categoryId) {
     if (!m_subCategoryIds.contains(categoryId)) {
         m_subCategoryIds.append(categoryId);
@@ -3,11 +3,13 @@
 
 #include <QString>
 #include <QUuid>
+#include <memory>
 #include <QVector>
 
 class Category {
 public:
     Category(const QString& id = QUuid::createUuid().toString());
+    static std::shared_ptr<Category> create(const QString& id = QUuid::createUuid().toString());
     
     // Getter和Setter
     QString getId() const { return m_id; }
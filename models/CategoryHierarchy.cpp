@@ -0,0 +1,127 @@
+#include "CategoryHierarchy.h"
+#include <algorithm>
+
+CategoryHierarchy::CategoryHierarchy() {
+}
+
+void CategoryHierarchy::rebuild(const QVector<std::shared_ptr<Category>>& categories) {
+    m_indexById.clear();
+    m_ids.clear();
+    m_parents.clear();
+    m_subtreeEnds.clear();
+    m_displayPaths.clear();
+    
+    QHash<QString, int> position; // 分类ID -> categories 下标
+    position.reserve(categories.size());
+    for (int i = 0; i < categories.size(); ++i) {
+        position.insert(categories[i]->getId(), i);
+    }
+    
+    // 按父分类分组，同级按排序号排列
+    QHash<QString, QVector<int>> children;
+    QVector<int> roots;
+    for (int i = 0; i < categories.size(); ++i) {
+        const QString parentId = categories[i]->getParentId();
+        if (parentId.isEmpty() || !position.contains(parentId)) {
+            roots.append(i);
+        } else {
+            children[parentId].append(i);
+        }
+    }
+    auto bySortOrder = [&categories](int a, int b) {
+        return categories[a]->getSortOrder() < categories[b]->getSortOrder();
+    };
+    std::stable_sort(roots.begin(), roots.end(), bySortOrder);
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        std::stable_sort(it.value().begin(), it.value().end(), bySortOrder);
+    }
+    
+    m_ids.reserve(categories.size());
+    m_parents.reserve(categories.size());
+    m_subtreeEnds.reserve(categories.size());
+    m_displayPaths.reserve(categories.size());
+    
+    // 迭代式先序遍历；栈元素为（分类下标，父节点编号）
+    QVector<bool> visited(categories.size(), false);
+    QVector<int> openNodes; // 尚未闭合子树的节点编号
+    auto visitFrom = [&](int root) {
+        QVector<QPair<int, int>> stack;
+        stack.append(qMakePair(root, -1));
+        while (!stack.isEmpty()) {
+            auto [current, parent] = stack.takeLast();
+            if (visited[current]) continue;
+            visited[current] = true;
+            
+            // 闭合不再是当前节点祖先的子树
+            while (!openNodes.isEmpty() && openNodes.last() != parent) {
+                m_subtreeEnds[openNodes.takeLast()] = m_ids.size();
+            }
+            
+            int index = m_ids.size();
+            const auto& category = categories[current];
+            m_indexById.insert(category->getId(), index);
+            m_ids.append(category->getId());
+            m_parents.append(parent);
+            m_subtreeEnds.append(index + 1);
+            m_displayPaths.append(parent < 0 ? category->getName()
+                                             : m_displayPaths[parent] + " > " + category->getName());
+            openNodes.append(index);
+            
+            const auto& kids = children.value(category->getId());
+            for (int k = kids.size() - 1; k >= 0; --k) {
+                stack.append(qMakePair(kids[k], index));
+            }
+        }
+        while (!openNodes.isEmpty()) {
+            m_subtreeEnds[openNodes.takeLast()] = m_ids.size();
+        }
+    };
+    
+    for (int root : roots) {
+        visitFrom(root);
+    }
+    // 处于环中的分类无法从根到达，从环上任一点断开
+    for (int i = 0; i < categories.size(); ++i) {
+        if (!visited[i]) {
+            visitFrom(i);
+        }
+    }
+}
+
+bool CategoryHierarchy::contains(const QString& ancestorId, const QString& categoryId) const {
+    int ancestor = indexOf(ancestorId);
+    int category = indexOf(categoryId);
+    if (ancestor < 0 || category < 0) {
+        return false;
+    }
+    return category >= ancestor && category < m_subtreeEnds[ancestor];
+}
+
+QVector<QString> CategoryHierarchy::subtreeIds(const QString& categoryId) const {
+    int index = indexOf(categoryId);
+    if (index < 0) {
+        return {categoryId};
+    }
+    QVector<QString> ids(m_ids.begin() + index, m_ids.begin() + m_subtreeEnds[index]);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QString CategoryHierarchy::displayPath(const QString& categoryId) const {
+    int index = indexOf(categoryId);
+    return index >= 0 ? m_displayPaths[index] : QString();
+}
+
+QVector<double> CategoryHierarchy::rollup(const QVector<double>& totals) const {
+    // 前缀和后，每个子树的合计就是一次区间求和
+    QVector<double> prefix(m_ids.size() + 1, 0.0);
+    for (int i = 0; i < m_ids.size(); ++i) {
+        prefix[i + 1] = prefix[i] + totals.value(i, 0.0);
+    }
+    
+    QVector<double> result(m_ids.size(), 0.0);
+    for (int i = 0; i < m_ids.size(); ++i) {
+        result[i] = prefix[m_subtreeEnds[i]] - prefix[i];
+    }
+    return result;
+}
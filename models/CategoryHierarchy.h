@@ -0,0 +1,45 @@
+#ifndef CATEGORYHIERARCHY_H
+#define CATEGORYHIERARCHY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <memory>
+#include "Category.h"
+
+// 分类层级索引：按先序遍历（欧拉序）为分类编号，
+// 每个分类的全部后代占据连续区间 [index, subtreeEnd)
+class CategoryHierarchy {
+public:
+    CategoryHierarchy();
+    
+    // 根据 parentId 重建索引
+    void rebuild(const QVector<std::shared_ptr<Category>>& categories);
+    
+    int size() const { return m_ids.size(); }
+    int indexOf(const QString& categoryId) const { return m_indexById.value(categoryId, -1); }
+    QString idAt(int index) const { return m_ids.value(index); }
+    int parentOf(int index) const { return m_parents.value(index, -1); }
+    int subtreeEnd(int index) const { return m_subtreeEnds.value(index, index); }
+    
+    // O(1) 判断 categoryId 是否位于 ancestorId 的子树中（含自身）
+    bool contains(const QString& ancestorId, const QString& categoryId) const;
+    // 子树包含的分类ID（含自身）按ID排序，不在层级中的分类只含自身
+    QVector<QString> subtreeIds(const QString& categoryId) const;
+    
+    // 缓存的显示路径，如 "餐饮 > 午餐"
+    QString displayPath(const QString& categoryId) const;
+    QString displayPathAt(int index) const { return m_displayPaths.value(index); }
+    
+    // 子树汇总：totals 按先序编号排列，返回每个分类含全部后代的合计
+    QVector<double> rollup(const QVector<double>& totals) const;
+    
+private:
+    QHash<QString, int> m_indexById;
+    QVector<QString> m_ids;
+    QVector<int> m_parents;
+    QVector<int> m_subtreeEnds;
+    QVector<QString> m_displayPaths;
+};
+
+#endif // CATEGORYHIERARCHY_H
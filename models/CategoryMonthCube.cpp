@@ -0,0 +1,92 @@
+#include "CategoryMonthCube.h"
+#include <algorithm>
+
+CategoryMonthCube::CategoryMonthCube(int categoryCount)
+    : m_categoryCount(std::max(0, categoryCount))
+    , m_firstMonth(0)
+    , m_monthCount(0) {
+}
+
+int CategoryMonthCube::rowOf(Record::Type type, int category) const {
+    if (category < 0 || category >= m_categoryCount) {
+        category = m_categoryCount;
+    }
+    int typeIndex = type == Record::Type::Income ? 1 : 0;
+    return typeIndex * (m_categoryCount + 1) + category;
+}
+
+void CategoryMonthCube::ensureMonth(int month) {
+    if (m_monthCount > 0 && month >= m_firstMonth && month < m_firstMonth + m_monthCount) {
+        return;
+    }
+    
+    // 每次向缺少的一侧多扩展一年，连续录入新月份时不必逐月重排
+    int first = month;
+    int last = month;
+    if (m_monthCount > 0) {
+        first = std::min(m_firstMonth, month < m_firstMonth ? month - kGrowMonths + 1 : month);
+        last = std::max(m_firstMonth + m_monthCount - 1, month >= m_firstMonth ? month + kGrowMonths - 1 : month);
+    }
+    int monthCount = last - first + 1;
+    int rows = 2 * (m_categoryCount + 1);
+    
+    QVector<Cell> cells(rows * monthCount);
+    for (int row = 0; row < rows && m_monthCount > 0; ++row) {
+        std::copy(m_cells.cbegin() + row * m_monthCount, m_cells.cbegin() + (row + 1) * m_monthCount,
+                  cells.begin() + row * monthCount + (m_firstMonth - first));
+    }
+    m_cells = std::move(cells);
+    m_firstMonth = first;
+    m_monthCount = monthCount;
+}
+
+void CategoryMonthCube::add(Record::Type type, int category, int month, double amount, int count) {
+    ensureMonth(month);
+    Cell& target = m_cells[rowOf(type, category) * m_monthCount + (month - m_firstMonth)];
+    target.amount += amount;
+    target.count += count;
+    // 全部撤销后清除浮点残差
+    if (target.count == 0) {
+        target.amount = 0.0;
+    }
+}
+
+CategoryMonthCube::Cell CategoryMonthCube::cell(Record::Type type, int category, int month) const {
+    if (month < m_firstMonth || month >= m_firstMonth + m_monthCount) {
+        return Cell();
+    }
+    return m_cells[rowOf(type, category) * m_monthCount + (month - m_firstMonth)];
+}
+
+QVector<CategoryMonthCube::Cell> CategoryMonthCube::categoryTotals(Record::Type type,
+                                                                   int firstMonth, int lastMonth) const {
+    QVector<Cell> totals(m_categoryCount + 1);
+    int begin = std::max(firstMonth, m_firstMonth) - m_firstMonth;
+    int end = std::min(lastMonth + 1, m_firstMonth + m_monthCount) - m_firstMonth;
+    if (begin >= end) {
+        return totals;
+    }
+    for (int category = 0; category <= m_categoryCount; ++category) {
+        const Cell* row = m_cells.constData() + rowOf(type, category) * m_monthCount;
+        for (int month = begin; month < end; ++month) {
+            totals[category].amount += row[month].amount;
+            totals[category].count += row[month].count;
+        }
+    }
+    return totals;
+}
+
+QVector<CategoryMonthCube::Cell> CategoryMonthCube::monthSeries(Record::Type type, int firstCategory, int endCategory,
+                                                                int firstMonth, int lastMonth) const {
+    QVector<Cell> series(std::max(0, lastMonth - firstMonth + 1));
+    firstCategory = std::max(0, firstCategory);
+    endCategory = std::min(endCategory, m_categoryCount + 1);
+    for (int category = firstCategory; category < endCategory; ++category) {
+        for (int i = 0; i < series.size(); ++i) {
+            Cell value = cell(type, category, firstMonth + i);
+            series[i].amount += value.amount;
+            series[i].count += value.count;
+        }
+    }
+    return series;
+}
@@ -0,0 +1,50 @@
+#ifndef CATEGORYMONTHCUBE_H
+#define CATEGORYMONTHCUBE_H
+
+#include <QDate>
+#include <QVector>
+#include "Record.h"
+
+// 分类 × 月份汇总立方体：按（收支类型，分类先序编号，月份）稠密存储金额和笔数，
+// 由记录变更增量维护；最后一个分类编号表示未知分类
+class CategoryMonthCube {
+public:
+    struct Cell {
+        double amount = 0.0;
+        int count = 0;
+    };
+    
+    explicit CategoryMonthCube(int categoryCount = 0);
+    
+    // 月份编号：year * 12 + month - 1
+    static int monthOf(const QDate& date) { return date.year() * 12 + date.month() - 1; }
+    static QDate monthStart(int month) { return QDate(month / 12, month % 12 + 1, 1); }
+    
+    int categoryCount() const { return m_categoryCount; }
+    int unknownCategory() const { return m_categoryCount; }
+    bool isEmpty() const { return m_monthCount == 0; }
+    
+    // category 为 -1 时计入未知分类；count 为 -1 时撤销一笔
+    void add(Record::Type type, int category, int month, double amount, int count);
+    Cell cell(Record::Type type, int category, int month) const;
+    
+    // 月份区间 [firstMonth, lastMonth] 内每个分类的合计，下标为分类编号
+    QVector<Cell> categoryTotals(Record::Type type, int firstMonth, int lastMonth) const;
+    // 分类区间 [firstCategory, endCategory) 逐月的合计，可直接传入子树区间
+    QVector<Cell> monthSeries(Record::Type type, int firstCategory, int endCategory,
+                              int firstMonth, int lastMonth) const;
+
+private:
+    static constexpr int kGrowMonths = 12;
+    
+    int rowOf(Record::Type type, int category) const;
+    void ensureMonth(int month);
+    
+    int m_categoryCount;
+    int m_firstMonth;
+    int m_monthCount;
+    // 每行是一个（类型，分类）的连续月份：[(type * (categoryCount + 1) + category) * monthCount + month]
+    QVector<Cell> m_cells;
+};
+
+#endif // CATEGORYMONTHCUBE_H
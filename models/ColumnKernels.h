@@ -0,0 +1,19 @@
+#ifndef COLUMNKERNELS_H
+#define COLUMNKERNELS_H
+
+#include <QtGlobal>
+
+// 列式数据上的求和内核：x86 上运行时检测 AVX2，不支持时使用标量实现
+// 两种实现按相同的 8 路累加顺序求和，结果逐位一致
+class ColumnKernels {
+public:
+    // kinds[i] == kind 的行的 amounts[i] 之和
+    static double sumWhereKind(const double* amounts, const quint8* kinds, int count, quint8 kind);
+    static double sumWhereKindScalar(const double* amounts, const quint8* kinds, int count, quint8 kind);
+    
+    // 当前 CPU 是否使用 AVX2 实现
+    static bool hasAvx2();
+    static const char* implementationName();
+};
+
+#endif // COLUMNKERNELS_H
@@ -0,0 +1,96 @@
+#include "DeadlineQueue.h"
+#include <algorithm>
+
+void DeadlineQueue::schedule(const QString& id, qint64 deadline) {
+    auto it = m_positions.constFind(id);
+    if (it != m_positions.constEnd()) {
+        int index = it.value();
+        m_heap[index].deadline = deadline;
+        siftUp(index);
+        siftDown(m_positions.value(id));
+        return;
+    }
+    
+    Entry entry;
+    entry.id = id;
+    entry.deadline = deadline;
+    m_heap.append(entry);
+    m_positions.insert(id, m_heap.size() - 1);
+    siftUp(m_heap.size() - 1);
+}
+
+bool DeadlineQueue::cancel(const QString& id) {
+    auto it = m_positions.constFind(id);
+    if (it == m_positions.constEnd()) {
+        return false;
+    }
+    removeAt(it.value());
+    return true;
+}
+
+void DeadlineQueue::clear() {
+    m_heap.clear();
+    m_positions.clear();
+}
+
+QVector<DeadlineQueue::Entry> DeadlineQueue::popDue(qint64 now) {
+    QVector<Entry> due;
+    while (!m_heap.isEmpty() && m_heap.first().deadline <= now) {
+        due.append(m_heap.first());
+        removeAt(0);
+    }
+    return due;
+}
+
+void DeadlineQueue::removeAt(int index) {
+    // 与堆尾交换后删除，再把换上来的节点调整到合适位置
+    int last = m_heap.size() - 1;
+    m_positions.remove(m_heap[index].id);
+    if (index != last) {
+        m_heap[index] = m_heap[last];
+        m_positions[m_heap[index].id] = index;
+    }
+    m_heap.removeLast();
+    if (index < m_heap.size()) {
+        const QString moved = m_heap[index].id;
+        siftUp(index);
+        siftDown(m_positions.value(moved));
+    }
+}
+
+void DeadlineQueue::siftUp(int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (m_heap[parent].deadline <= m_heap[index].deadline) {
+            break;
+        }
+        swapNodes(parent, index);
+        index = parent;
+    }
+}
+
+void DeadlineQueue::siftDown(int index) {
+    const int size = m_heap.size();
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if (left < size && m_heap[left].deadline < m_heap[smallest].deadline) {
+            smallest = left;
+        }
+        if (right < size && m_heap[right].deadline < m_heap[smallest].deadline) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
+void DeadlineQueue::swapNodes(int a, int b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_positions[m_heap[a].id] = a;
+    m_positions[m_heap[b].id] = b;
+}
@@ -0,0 +1,41 @@
+#ifndef DEADLINEQUEUE_H
+#define DEADLINEQUEUE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// 按到期时间排序的定时任务队列：带下标索引的最小堆，插入、改期、取消均为 O(log n)，
+// 查看最早到期项为 O(1)。时间为自纪元起的毫秒数
+class DeadlineQueue {
+public:
+    struct Entry {
+        QString id;
+        qint64 deadline = 0;
+    };
+    
+    // id 已存在时改为新的到期时间
+    void schedule(const QString& id, qint64 deadline);
+    bool cancel(const QString& id);
+    bool contains(const QString& id) const { return m_positions.contains(id); }
+    void clear();
+    
+    bool isEmpty() const { return m_heap.isEmpty(); }
+    int size() const { return m_heap.size(); }
+    // 队列为空时不可调用
+    const Entry& next() const { return m_heap.first(); }
+    
+    // 取出所有到期时间不晚于 now 的项，按到期时间从早到晚
+    QVector<Entry> popDue(qint64 now);
+
+private:
+    void removeAt(int index);
+    void siftUp(int index);
+    void siftDown(int index);
+    void swapNodes(int a, int b);
+    
+    QVector<Entry> m_heap;
+    QHash<QString, int> m_positions;
+};
+
+#endif // DEADLINEQUEUE_H
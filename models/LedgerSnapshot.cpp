@@ -0,0 +1,106 @@
+#include "LedgerSnapshot.h"
+#include "ColumnKernels.h"
+
+void LedgerChunk::append(qint64 day, double amount, Record::Type type, int category, int note) {
+    if (days.isEmpty()) {
+        minDay = day;
+    }
+    maxDay = day;
+    days.append(day);
+    amounts.append(amount);
+    kinds.append(static_cast<quint8>(type));
+    categories.append(category);
+    notes.append(note);
+}
+
+void LedgerChunk::rowRange(qint64 startDay, qint64 endDay, int& begin, int& end) const {
+    begin = 0;
+    end = days.size();
+    if (startDay > endDay || days.isEmpty() || maxDay < startDay || minDay > endDay) {
+        end = 0;
+        return;
+    }
+    // 整块落在范围内时无需二分
+    if (minDay < startDay) {
+        begin = std::lower_bound(days.cbegin(), days.cend(), startDay) - days.cbegin();
+    }
+    if (maxDay > endDay) {
+        end = std::upper_bound(days.cbegin(), days.cend(), endDay) - days.cbegin();
+    }
+}
+
+LedgerSnapshot::LedgerSnapshot(quint64 version,
+                               std::shared_ptr<const CategoryHierarchy> hierarchy,
+                               QVector<ChunkPtr> chunks)
+    : m_version(version)
+    , m_hierarchy(hierarchy ? std::move(hierarchy) : std::make_shared<const CategoryHierarchy>())
+    , m_chunks(std::move(chunks))
+    , m_rowCount(0) {
+    for (const auto& chunk : m_chunks) {
+        m_rowCount += chunk->size();
+    }
+}
+
+int LedgerSnapshot::chunkFor(qint64 day) const {
+    auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), day,
+        [](qint64 value, const ChunkPtr& chunk) {
+            return value < chunk->minDay;
+        });
+    return it == m_chunks.cbegin() ? 0 : int(it - m_chunks.cbegin()) - 1;
+}
+
+int LedgerSnapshot::countInRange(const QDate& start, const QDate& end) const {
+    int count = 0;
+    qint64 startDay = start.toJulianDay();
+    qint64 endDay = end.toJulianDay();
+    
+    for (int c = chunkFor(startDay); c < m_chunks.size() && m_chunks[c]->minDay <= endDay; ++c) {
+        int begin = 0;
+        int stop = 0;
+        m_chunks[c]->rowRange(startDay, endDay, begin, stop);
+        count += stop - begin;
+    }
+    
+    return count;
+}
+
+double LedgerSnapshot::totalInRange(const QDate& start, const QDate& end, Record::Type type) const {
+    double total = 0.0;
+    qint64 startDay = start.toJulianDay();
+    qint64 endDay = end.toJulianDay();
+    const quint8 kind = static_cast<quint8>(type);
+    
+    // 块内范围连续，按类型过滤求和交给向量化内核
+    for (int c = chunkFor(startDay); c < m_chunks.size() && m_chunks[c]->minDay <= endDay; ++c) {
+        const LedgerChunk& chunk = *m_chunks[c];
+        int begin = 0;
+        int stop = 0;
+        chunk.rowRange(startDay, endDay, begin, stop);
+        total += ColumnKernels::sumWhereKind(chunk.amounts.constData() + begin,
+                                             chunk.kinds.constData() + begin, stop - begin, kind);
+    }
+    
+    return total;
+}
+
+QVector<double> LedgerSnapshot::categoryTotals(const QDate& start, const QDate& end, Record::Type type,
+                                               double* unknownTotal) const {
+    QVector<double> totals(m_hierarchy->size(), 0.0);
+    double unknown = 0.0;
+    const quint8 kind = static_cast<quint8>(type);
+    forEachRowInRange(start, end, [&](const LedgerChunk& chunk, int row) {
+        if (chunk.kinds[row] != kind) {
+            return;
+        }
+        int category = chunk.categories[row];
+        if (category >= 0) {
+            totals[category] += chunk.amounts[row];
+        } else {
+            unknown += chunk.amounts[row];
+        }
+    });
+    if (unknownTotal) {
+        *unknownTotal = unknown;
+    }
+    return totals;
+}
@@ -0,0 +1,86 @@
+#ifndef LEDGERSNAPSHOT_H
+#define LEDGERSNAPSHOT_H
+
+#include <QDate>
+#include <QVector>
+#include <algorithm>
+#include <memory>
+#include "Record.h"
+#include "CategoryHierarchy.h"
+
+// 快照数据块：按日期升序的一段记录，按列存储
+// 同一天的记录不会跨块，因此单日记录过多时块可以超过 kChunkRows
+struct LedgerChunk {
+    static constexpr int kChunkRows = 4096;
+
+    QVector<qint64> days;       // 本地日期的儒略日
+    QVector<double> amounts;
+    QVector<quint8> kinds;      // Record::Type
+    QVector<int> categories;    // 分类在层级索引中的先序编号，-1 表示未知分类
+    QVector<int> notes;         // 备注在字符串池中的编号
+    qint64 minDay = 0;
+    qint64 maxDay = -1;
+
+    int size() const { return days.size(); }
+    void append(qint64 day, double amount, Record::Type type, int category, int note);
+
+    // 计算落在 [startDay, endDay] 内的行区间 [begin, end)
+    void rowRange(qint64 startDay, qint64 endDay, int& begin, int& end) const;
+};
+
+// 不可变的账本快照：写线程在每次数据变更后发布新版本，
+// 未受影响的数据块在新旧版本间共享；读线程持有快照期间数据不会改变。
+// 只包含未删除且设置了时间的记录
+class LedgerSnapshot {
+public:
+    using ChunkPtr = std::shared_ptr<const LedgerChunk>;
+
+    LedgerSnapshot(quint64 version,
+                   std::shared_ptr<const CategoryHierarchy> hierarchy,
+                   QVector<ChunkPtr> chunks);
+
+    quint64 version() const { return m_version; }
+    const CategoryHierarchy& hierarchy() const { return *m_hierarchy; }
+    const std::shared_ptr<const CategoryHierarchy>& hierarchyPtr() const { return m_hierarchy; }
+    const QVector<ChunkPtr>& chunks() const { return m_chunks; }
+    int rowCount() const { return m_rowCount; }
+
+    // 包含该日期的数据块下标（最后一个 minDay <= day 的块）
+    int chunkFor(qint64 day) const;
+
+    // 按日期顺序遍历范围内的行，visit(const LedgerChunk&, int row)
+    template <typename Visitor>
+    void forEachRowInRange(const QDate& start, const QDate& end, Visitor&& visit) const;
+
+    // 汇总查询
+    int countInRange(const QDate& start, const QDate& end) const;
+    double totalInRange(const QDate& start, const QDate& end, Record::Type type) const;
+    // 按分类先序编号累计金额，可直接交给 CategoryHierarchy::rollup；
+    // 未归入已知分类的金额累加到 unknownTotal（如提供）
+    QVector<double> categoryTotals(const QDate& start, const QDate& end, Record::Type type,
+                                   double* unknownTotal = nullptr) const;
+
+private:
+    quint64 m_version;
+    std::shared_ptr<const CategoryHierarchy> m_hierarchy;
+    QVector<ChunkPtr> m_chunks;
+    int m_rowCount;
+};
+
+template <typename Visitor>
+void LedgerSnapshot::forEachRowInRange(const QDate& start, const QDate& end, Visitor&& visit) const {
+    qint64 startDay = start.toJulianDay();
+    qint64 endDay = end.toJulianDay();
+
+    for (int c = chunkFor(startDay); c < m_chunks.size() && m_chunks[c]->minDay <= endDay; ++c) {
+        const LedgerChunk& chunk = *m_chunks[c];
+        int begin = 0;
+        int stop = 0;
+        chunk.rowRange(startDay, endDay, begin, stop);
+        for (int row = begin; row < stop; ++row) {
+            visit(chunk, row);
+        }
+    }
+}
+
+#endif // LEDGERSNAPSHOT_H
@@ -0,0 +1,129 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// 定长块的slab池：按整块向系统申请内存，块地址在生命周期内不变，
+// 释放的块挂回空闲链表复用，整块内存不归还给系统。
+// 与一般的arena不同：记录、分类、预算以 shared_ptr 在界面、变更事件和异步报表任务间共享，
+// 句柄仍是 shared_ptr（控制块与对象同放一个块，不再单独分配），最后一个引用可能在任意线程释放，
+// 因此分配和释放都加锁；对象各自计数，无法整体一次释放，slab 在进程退出时由系统回收
+template <std::size_t BlockSize, std::size_t BlockAlign>
+class SlabPool {
+public:
+    // 池有意不析构：静态对象持有的shared_ptr可能在静态析构阶段晚于池释放
+    static SlabPool& instance() {
+        static SlabPool* pool = new SlabPool;
+        return *pool;
+    }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_freeList) {
+            grow();
+        }
+        FreeNode* node = m_freeList;
+        m_freeList = node->next;
+        ++m_liveCount;
+        return node;
+    }
+
+    void deallocate(void* block) noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        FreeNode* node = static_cast<FreeNode*>(block);
+        node->next = m_freeList;
+        m_freeList = node;
+        --m_liveCount;
+    }
+
+    std::size_t liveCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_liveCount;
+    }
+
+    std::size_t slabCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_slabs.size();
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    static constexpr std::size_t kAlign = std::max(BlockAlign, alignof(FreeNode));
+    static constexpr std::size_t kStride =
+        (std::max(BlockSize, sizeof(FreeNode)) + kAlign - 1) / kAlign * kAlign;
+    static constexpr std::size_t kFirstSlabBlocks = 64;
+    static constexpr std::size_t kMaxSlabBlocks = 65536;
+
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    // 每次扩容块数翻倍，百万级记录只需几十次大块分配
+    void grow() {
+        std::size_t blocks = m_nextSlabBlocks;
+        m_nextSlabBlocks = std::min(m_nextSlabBlocks * 2, kMaxSlabBlocks);
+
+        char* slab = static_cast<char*>(::operator new(blocks * kStride, std::align_val_t(kAlign)));
+        m_slabs.push_back(slab);
+
+        for (std::size_t i = blocks; i > 0; --i) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(slab + (i - 1) * kStride);
+            node->next = m_freeList;
+            m_freeList = node;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<void*> m_slabs;
+    FreeNode* m_freeList = nullptr;
+    std::size_t m_nextSlabBlocks = kFirstSlabBlocks;
+    std::size_t m_liveCount = 0;
+};
+
+// 供std::allocate_shared使用的分配器，对象与控制块一起放入slab池
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n != 1) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(SlabPool<sizeof(T), alignof(T)>::instance().allocate());
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n != 1) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        SlabPool<sizeof(T), alignof(T)>::instance().deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+// Record、Category、Budget 的 create() 通过它分配，批量创建时避免逐个堆分配
+template <typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+#endif // OBJECTPOOL_H
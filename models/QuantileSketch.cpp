@@ -0,0 +1,140 @@
+#include "QuantileSketch.h"
+#include <QPair>
+#include <algorithm>
+#include <cmath>
+
+QuantileSketch::QuantileSketch(int k)
+    : m_k(std::max(8, k))
+    , m_count(0)
+    , m_min(0.0)
+    , m_max(0.0)
+    , m_coin(false)
+    , m_retained(0)
+    , m_totalCapacity(0) {
+    resizeLevels(1);
+}
+
+int QuantileSketch::capacity(int level) const {
+    // 最高层容量为 k，往下每层乘以 2/3
+    int depth = m_levels.size() - 1 - level;
+    return std::max(2, int(std::ceil(m_k * std::pow(2.0 / 3.0, depth))));
+}
+
+void QuantileSketch::resizeLevels(int levelCount) {
+    m_levels.resize(levelCount);
+    m_totalCapacity = 0;
+    for (int level = 0; level < levelCount; ++level) {
+        m_totalCapacity += capacity(level);
+    }
+}
+
+void QuantileSketch::insert(double value) {
+    if (m_count == 0) {
+        m_min = value;
+        m_max = value;
+    } else {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+    ++m_count;
+    ++m_retained;
+    m_levels[0].append(value);
+    if (m_retained > m_totalCapacity) {
+        compress();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.m_count == 0) {
+        return;
+    }
+    if (m_count == 0) {
+        m_min = other.m_min;
+        m_max = other.m_max;
+    } else {
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+    m_count += other.m_count;
+    
+    if (m_levels.size() < other.m_levels.size()) {
+        resizeLevels(other.m_levels.size());
+    }
+    for (int level = 0; level < other.m_levels.size(); ++level) {
+        m_levels[level] += other.m_levels[level];
+    }
+    m_retained += other.m_retained;
+    compress();
+}
+
+void QuantileSketch::compress() {
+    // 总样本数超出总容量时，从最低的超容量层开始压缩，直到满足容量
+    while (m_retained > m_totalCapacity) {
+        for (int level = 0; level < m_levels.size(); ++level) {
+            if (m_levels[level].size() >= capacity(level)) {
+                compactLevel(level);
+                break;
+            }
+        }
+    }
+}
+
+void QuantileSketch::compactLevel(int level) {
+    if (level + 1 >= m_levels.size()) {
+        resizeLevels(level + 2);
+    }
+    
+    QVector<double>& items = m_levels[level];
+    std::sort(items.begin(), items.end());
+    // 个数为奇数时留下最大的一个，其余成对压缩，总权重不变
+    double leftover = 0.0;
+    bool hasLeftover = items.size() % 2 == 1;
+    if (hasLeftover) {
+        leftover = items.takeLast();
+    }
+    
+    QVector<double>& promoted = m_levels[level + 1];
+    for (int i = m_coin ? 1 : 0; i < items.size(); i += 2) {
+        promoted.append(items[i]);
+    }
+    m_coin = !m_coin;
+    
+    m_retained -= items.size() / 2;
+    items.clear();
+    if (hasLeftover) {
+        items.append(leftover);
+    }
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    if (q <= 0.0) {
+        return m_min;
+    }
+    if (q >= 1.0) {
+        return m_max;
+    }
+    
+    QVector<QPair<double, quint64>> weighted;
+    weighted.reserve(m_retained);
+    for (int level = 0; level < m_levels.size(); ++level) {
+        for (double value : m_levels[level]) {
+            weighted.append(qMakePair(value, quint64(1) << level));
+        }
+    }
+    std::sort(weighted.begin(), weighted.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    
+    quint64 rank = std::max<quint64>(1, quint64(std::ceil(q * double(m_count))));
+    quint64 cumulative = 0;
+    for (const auto& item : weighted) {
+        cumulative += item.second;
+        if (cumulative >= rank) {
+            return item.first;
+        }
+    }
+    return m_max;
+}
@@ -0,0 +1,44 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <QVector>
+
+// 可合并的分位数草图（KLL）：第 h 层的每个样本代表 2^h 个原始值，
+// 某层超出容量时排序后隔一个取一个提升到上一层；越低的层容量越小。
+// 值的个数不超过 k 时结果精确，否则秩误差约为 O(1/k)
+class QuantileSketch {
+public:
+    static constexpr int kDefaultK = 200;
+    
+    explicit QuantileSketch(int k = kDefaultK);
+    
+    void insert(double value);
+    void merge(const QuantileSketch& other);
+    
+    // 最近秩分位数：返回第 ceil(q * count) 小的值，q 取 [0, 1]；没有数据时返回 0
+    double quantile(double q) const;
+    
+    quint64 count() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    double min() const { return m_min; }
+    double max() const { return m_max; }
+    // 实际保存的样本数，不超过约 3k
+    int retainedCount() const { return m_retained; }
+
+private:
+    int capacity(int level) const;
+    void resizeLevels(int levelCount);
+    void compress();
+    void compactLevel(int level);
+    
+    int m_k;
+    quint64 m_count;
+    double m_min;
+    double m_max;
+    bool m_coin;                        // 压缩时交替保留奇数位、偶数位，结果可复现
+    int m_retained;
+    int m_totalCapacity;                // 各层容量之和，层数变化时重新计算
+    QVector<QVector<double>> m_levels;
+};
+
+#endif // QUANTILESKETCH_H
@@ -1,14 +1,72 @@
 #include "Record.h"
+#include "ObjectPool.h"
+#include "StringPool.h"
 
 Record::Record(const QString& id) 
     : m_id(id.isEmpty() ? QUuid::createUuid().toString() : id)
     , m_type(Type::Expense)
     , m_amount(0.0)
+    , m_timestamp(kInvalidTimestamp)
+    , m_day(kInvalidTimestamp)
+    , m_noteId(0)
     , m_status(Status::Draft)
-    , m_createdAt(QDateTime::currentDateTime())
+    , m_revision(0)
+    , m_createdAt(QDateTime::currentMSecsSinceEpoch())
     , m_updatedAt(m_createdAt) {
 }
 
+std::shared_ptr<Record> Record::create(const QString& id) {
+    return makePooled<Record>(id);
+}
+
+void Record::setDateTime(const QDateTime& dateTime) {
+    touch();
+    if (!dateTime.isValid()) {
+        m_timestamp = kInvalidTimestamp;
+        m_day = kInvalidTimestamp;
+        return;
+    }
+    m_timestamp = dateTime.toMSecsSinceEpoch();
+    m_day = dateTime.toLocalTime().date().toJulianDay();
+}
+
+void Record::setTimestamp(qint64 msecsSinceEpoch) {
+    setDateTime(toDateTime(msecsSinceEpoch));
+}
+
+const QString& Record::getNote() const {
+    return StringPool::notes().at(m_noteId);
+}
+
+void Record::setNote(const QString& note) {
+    m_noteId = StringPool::notes().intern(note);
+    touch();
+}
+
+void Record::touch() {
+    ++m_revision;
+    m_editCounter.mark();
+}
+
+void Record::setEditCounter(int* counter) {
+    markEditReported();
+    m_editCounter.counter = counter;
+}
+
+void Record::markEditReported() {
+    if (m_editCounter.pending) {
+        m_editCounter.pending = false;
+        --*m_editCounter.counter;
+    }
+}
+
+QDateTime Record::toDateTime(qint64 msecsSinceEpoch) {
+    if (msecsSinceEpoch == kInvalidTimestamp) {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch);
+}
+
 QString Record::getTypeString() const {
     switch (m_type) {
         case Type::Income:
@@ -4,6 +4,8 @@
 #include <QString>
 #include <QDateTime>
 #include <QUuid>
+#include <limits>
+#include <memory>
 
 class Record {
 public:
@@ -21,24 +23,40 @@ public:
     };
     
     Record(const QString& id = QUuid::createUuid().toString());
+    static std::shared_ptr<Record> create(const QString& id = QUuid::createUuid().toString());
     
     // Getter和Setter
     QString getId() const { return m_id; }
     
     Type getType() const { return m_type; }
-    void setType(Type type) { m_type = type; }
+    void setType(Type type) { m_type = type; touch(); }
     
     double getAmount() const { return m_amount; }
-    void setAmount(double amount) { m_amount = amount; }
+    void setAmount(double amount) { m_amount = amount; touch(); }
     
     QString getCategoryId() const { return m_categoryId; }
-    void setCategoryId(const QString& categoryId) { m_categoryId = categoryId; }
+    void setCategoryId(const QString& categoryId) { m_categoryId = categoryId; touch(); }
     
-    QDateTime getDateTime() const { return m_dateTime; }
-    void setDateTime(const QDateTime& dateTime) { m_dateTime = dateTime; }
+    // 时间以UTC毫秒存储，QDateTime仅在显示时转换
+    QDateTime getDateTime() const { return toDateTime(m_timestamp); }
+    void setDateTime(const QDateTime& dateTime);
+    qint64 getTimestamp() const { return m_timestamp; }
+    void setTimestamp(qint64 msecsSinceEpoch);
+    // 本地日期的儒略日，按日期筛选时无需构造QDateTime
+    qint64 getDay() const { return m_day; }
+    QDate getDate() const { return QDate::fromJulianDay(m_day); }
     
-    QString getNote() const { return m_note; }
-    void setNote(const QString& note) { m_note = note; }
+    // 备注驻留在字符串池中，相同备注共享同一编号；返回的引用在进程生命周期内有效
+    const QString& getNote() const;
+    void setNote(const QString& note);
+    int getNoteId() const { return m_noteId; }
+    
+    // 类型、金额、分类、时间、备注每次修改递增；记录加入 User 后原地修改须调用 User::updateRecord
+    quint32 getRevision() const { return m_revision; }
+    // 由所属 User 管理：记录在账本中时，首次未登记的修改使账本的计数加一，
+    // markEditReported（User::updateRecord 中调用）登记后减一，User 据此 O(1) 判断快照是否过期
+    void setEditCounter(int* counter);
+    void markEditReported();
     
     Status getStatus() const { return m_status; }
     void setStatus(Status status) { m_status = status; }
@@ -46,26 +64,50 @@ public:
     bool isDeleted() const { return m_status == Status::Deleted; }
     void markAsDeleted() { m_status = Status::Deleted; }
     
-    QDateTime getCreatedAt() const { return m_createdAt; }
-    QDateTime getUpdatedAt() const { return m_updatedAt; }
-    void updateTimestamp() { m_updatedAt = QDateTime::currentDateTime(); }
+    QDateTime getCreatedAt() const { return toDateTime(m_createdAt); }
+    QDateTime getUpdatedAt() const { return toDateTime(m_updatedAt); }
+    void updateTimestamp() { m_updatedAt = QDateTime::currentMSecsSinceEpoch(); }
     
     // 辅助方法
     bool isIncome() const { return m_type == Type::Income; }
     bool isExpense() const { return m_type == Type::Expense; }
     QString getTypeString() const;
     
+    static constexpr qint64 kInvalidTimestamp = std::numeric_limits<qint64>::min();
+    
 private:
+    static QDateTime toDateTime(qint64 msecsSinceEpoch);
+    void touch();
+    
+    // 复制记录（如修改前的副本）时不复制所属账本；整体赋值给账本中的记录视为一次修改
+    struct EditCounter {
+        int* counter = nullptr;
+        bool pending = false;
+        
+        EditCounter() = default;
+        EditCounter(const EditCounter&) {}
+        EditCounter& operator=(const EditCounter&) { mark(); return *this; }
+        void mark() {
+            if (counter && !pending) {
+                pending = true;
+                ++*counter;
+            }
+        }
+    };
+    
     QString m_id;
     Type m_type;
     double m_amount;
     QString m_categoryId;
-    QDateTime m_dateTime;
-    QString m_note;
+    qint64 m_timestamp;
+    qint64 m_day;
+    int m_noteId;
     Status m_status;
+    quint32 m_revision;
+    EditCounter m_editCounter;
     
-    QDateTime m_createdAt;
-    QDateTime m_updatedAt;
+    qint64 m_createdAt;
+    qint64 m_updatedAt;
 };
 
 #endif // RECORD_H
\ No newline at end of file
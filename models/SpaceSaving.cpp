@@ -0,0 +1,88 @@
+#include "SpaceSaving.h"
+#include <algorithm>
+
+SpaceSaving::SpaceSaving(int capacity)
+    : m_capacity(std::max(1, capacity))
+    , m_total(0.0) {
+    m_heap.reserve(m_capacity);
+    m_positions.reserve(m_capacity);
+}
+
+void SpaceSaving::add(quint64 key, double weight, int label) {
+    m_total += weight;
+    
+    auto it = m_positions.constFind(key);
+    if (it != m_positions.constEnd()) {
+        int index = it.value();
+        m_heap[index].count += weight;
+        siftDown(index);
+        return;
+    }
+    
+    if (m_heap.size() < m_capacity) {
+        // 新计数器放在堆尾后上浮
+        Counter counter;
+        counter.key = key;
+        counter.label = label;
+        counter.count = weight;
+        int index = m_heap.size();
+        m_heap.append(counter);
+        m_positions.insert(key, index);
+        while (index > 0) {
+            int parent = (index - 1) / 2;
+            if (m_heap[parent].count <= m_heap[index].count) {
+                break;
+            }
+            swapNodes(parent, index);
+            index = parent;
+        }
+        return;
+    }
+    
+    // 替换计数最小的计数器（堆顶），被替换键的计数成为新键的误差上界
+    Counter& root = m_heap[0];
+    m_positions.remove(root.key);
+    root.error = root.count;
+    root.count += weight;
+    root.key = key;
+    root.label = label;
+    m_positions.insert(key, 0);
+    siftDown(0);
+}
+
+void SpaceSaving::siftDown(int index) {
+    const int size = m_heap.size();
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if (left < size && m_heap[left].count < m_heap[smallest].count) {
+            smallest = left;
+        }
+        if (right < size && m_heap[right].count < m_heap[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        swapNodes(index, smallest);
+        index = smallest;
+    }
+}
+
+void SpaceSaving::swapNodes(int a, int b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_positions[m_heap[a].key] = a;
+    m_positions[m_heap[b].key] = b;
+}
+
+QVector<SpaceSaving::Counter> SpaceSaving::top(int k) const {
+    QVector<Counter> counters = m_heap;
+    std::sort(counters.begin(), counters.end(), [](const Counter& a, const Counter& b) {
+        return a.count > b.count;
+    });
+    if (k >= 0 && k < counters.size()) {
+        counters.resize(k);
+    }
+    return counters;
+}
@@ -0,0 +1,42 @@
+#ifndef SPACESAVING_H
+#define SPACESAVING_H
+
+#include <QHash>
+#include <QVector>
+
+// Space-Saving 频繁项统计（带权）：最多跟踪 capacity 个键，计数器已满时新键替换计数最小的
+// 计数器并继承其计数作为误差上界。任一被跟踪键的真实累计值在 [count - error, count] 内，
+// 累计值超过 total / capacity 的键一定被跟踪。每个计数器另带一个 label，记录占用该计数器的
+// 键第一次出现时调用方传入的值（如用于显示的原始编号），内存只与 capacity 有关
+class SpaceSaving {
+public:
+    struct Counter {
+        quint64 key = 0;
+        int label = 0;
+        double count = 0.0;
+        double error = 0.0;
+    };
+    
+    explicit SpaceSaving(int capacity);
+    
+    // weight 应为非负数
+    void add(quint64 key, double weight, int label = 0);
+    // 计数最大的 k 个计数器，按计数从大到小
+    QVector<Counter> top(int k) const;
+    
+    int capacity() const { return m_capacity; }
+    int size() const { return m_heap.size(); }
+    double total() const { return m_total; }
+
+private:
+    // 按计数的最小堆，m_positions 记录每个键在堆中的下标
+    void siftDown(int index);
+    void swapNodes(int a, int b);
+    
+    int m_capacity;
+    double m_total;
+    QVector<Counter> m_heap;
+    QHash<quint64, int> m_positions;
+};
+
+#endif // SPACESAVING_H
@@ -0,0 +1,69 @@
+#include "SpendingForecast.h"
+#include <algorithm>
+
+SpendingForecast::SpendingForecast(double alpha, double gamma)
+    : m_alpha(alpha)
+    , m_gamma(gamma)
+    , m_level(0.0)
+    , m_seasonal{}
+    , m_pending(0.0)
+    , m_foldedDays(0) {
+}
+
+void SpendingForecast::reset(const QDate& firstDay) {
+    m_level = 0.0;
+    std::fill(std::begin(m_seasonal), std::end(m_seasonal), 0.0);
+    m_day = firstDay;
+    m_pending = 0.0;
+    m_foldedDays = 0;
+}
+
+bool SpendingForecast::add(const QDate& day, double amount) {
+    if (!m_day.isValid()) {
+        reset(day);
+    }
+    if (day < m_day) {
+        return false;
+    }
+    advanceTo(day);
+    m_pending += amount;
+    return true;
+}
+
+void SpendingForecast::advanceTo(const QDate& day) {
+    if (!m_day.isValid()) {
+        reset(day);
+        return;
+    }
+    while (m_day < day) {
+        foldDay(m_pending);
+        m_pending = 0.0;
+        m_day = m_day.addDays(1);
+    }
+}
+
+void SpendingForecast::foldDay(double amount) {
+    double& seasonal = m_seasonal[m_day.dayOfWeek() - 1];
+    ++m_foldedDays;
+    if (m_foldedDays <= kWarmupDays) {
+        m_level += (amount - m_level) / m_foldedDays;
+        return;
+    }
+    m_level = m_alpha * (amount - seasonal) + (1.0 - m_alpha) * m_level;
+    seasonal = m_gamma * (amount - m_level) + (1.0 - m_gamma) * seasonal;
+}
+
+double SpendingForecast::dailyForecast(const QDate& day) const {
+    if (m_foldedDays == 0) {
+        return 0.0;
+    }
+    return std::max(0.0, m_level + m_seasonal[day.dayOfWeek() - 1]);
+}
+
+double SpendingForecast::projectRange(const QDate& from, const QDate& to) const {
+    double total = 0.0;
+    for (QDate day = from; day <= to; day = day.addDays(1)) {
+        total += dailyForecast(day);
+    }
+    return total;
+}
@@ -0,0 +1,49 @@
+#ifndef SPENDINGFORECAST_H
+#define SPENDINGFORECAST_H
+
+#include <QDate>
+
+// 每日支出的指数平滑预测（水平 + 星期加性季节项）。记录按日期顺序逐笔加入：
+// 同一天的金额先累计，日期前进时把已结束的日子（含无支出的日子）依次折入状态，
+// 每笔记录的更新只与经过的天数有关，无需重新拟合
+class SpendingForecast {
+public:
+    static constexpr double kDefaultAlpha = 0.2;   // 水平的平滑系数
+    static constexpr double kDefaultGamma = 0.1;   // 星期季节项的平滑系数
+    
+    explicit SpendingForecast(double alpha = kDefaultAlpha, double gamma = kDefaultGamma);
+    
+    // 从 firstDay 开始重新累计
+    void reset(const QDate& firstDay);
+    
+    // 加入一笔支出；日期早于当前日（已折入状态）时返回 false，调用方需重新拟合
+    bool add(const QDate& day, double amount);
+    // 把 day 之前的日子全部折入状态，day 成为当前日
+    void advanceTo(const QDate& day);
+    
+    bool isValid() const { return m_day.isValid(); }
+    QDate currentDay() const { return m_day; }
+    double currentDayAmount() const { return m_pending; }
+    int foldedDays() const { return m_foldedDays; }
+    
+    // 某一天的预测支出（不小于 0）
+    double dailyForecast(const QDate& day) const;
+    // [from, to] 每日预测之和
+    double projectRange(const QDate& from, const QDate& to) const;
+
+private:
+    // 前一周按已折入日子的均值初始化水平，之后按平滑公式更新
+    static constexpr int kWarmupDays = 7;
+    
+    void foldDay(double amount);
+    
+    double m_alpha;
+    double m_gamma;
+    double m_level;
+    double m_seasonal[7];       // 下标为 dayOfWeek() - 1
+    QDate m_day;
+    double m_pending;
+    int m_foldedDays;
+};
+
+#endif // SPENDINGFORECAST_H
@@ -0,0 +1,72 @@
+#include "StringPool.h"
+
+StringPool& StringPool::notes() {
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool()
+    : m_chunks(new std::atomic<QString*>[kMaxChunks])
+    , m_size(1) {
+    for (int i = 0; i < kMaxChunks; ++i) {
+        m_chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+    m_chunks[0].store(new QString[kChunkSize], std::memory_order_relaxed);
+    m_ids.insert(QString(), 0);
+}
+
+StringPool::~StringPool() {
+    for (int i = 0; i < kMaxChunks; ++i) {
+        delete[] m_chunks[i].load(std::memory_order_relaxed);
+    }
+}
+
+int StringPool::intern(const QString& text) {
+    if (text.isEmpty()) {
+        return 0;
+    }
+    
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(text);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+    }
+    
+    QWriteLocker locker(&m_lock);
+    auto it = m_ids.constFind(text);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    
+    int id = m_size.load(std::memory_order_relaxed);
+    if ((id >> kChunkBits) >= kMaxChunks) {
+        qFatal("StringPool: capacity of %d strings exceeded", kMaxChunks * kChunkSize);
+    }
+    if ((id & (kChunkSize - 1)) == 0) {
+        m_chunks[id >> kChunkBits].store(new QString[kChunkSize], std::memory_order_relaxed);
+    }
+    m_chunks[id >> kChunkBits].load(std::memory_order_relaxed)[id & (kChunkSize - 1)] = text;
+    m_ids.insert(text, id);
+    // 槽位写完后再发布，读取方看到新的 size 时必然也能看到字符串内容
+    m_size.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+int StringPool::find(const QString& text) const {
+    QReadLocker locker(&m_lock);
+    return m_ids.value(text, -1);
+}
+
+const QString& StringPool::at(int id) const {
+    const QString* empty = m_chunks[0].load(std::memory_order_relaxed);
+    if (id <= 0 || id >= m_size.load(std::memory_order_acquire)) {
+        return empty[0];
+    }
+    return m_chunks[id >> kChunkBits].load(std::memory_order_relaxed)[id & (kChunkSize - 1)];
+}
+
+int StringPool::size() const {
+    return m_size.load(std::memory_order_acquire);
+}
@@ -0,0 +1,44 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QHash>
+#include <QReadWriteLock>
+#include <atomic>
+#include <memory>
+
+// 字符串驻留池：相同内容只保存一份，以整数编号引用
+// 编号0固定表示空字符串；已驻留的字符串在进程生命周期内地址不变
+// 按编号读取不加锁：写入方先填好槽位，再以 release 语义发布新的 m_size
+class StringPool {
+public:
+    static StringPool& notes();
+    
+    StringPool();
+    ~StringPool();
+    
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    
+    // 返回字符串的编号，首次出现时加入池中
+    int intern(const QString& text);
+    // 查找已有编号，不存在时返回 -1
+    int find(const QString& text) const;
+    const QString& at(int id) const;
+    
+    int size() const;
+    
+private:
+    static constexpr int kChunkBits = 10;
+    static constexpr int kChunkSize = 1 << kChunkBits;
+    // 块目录固定大小，扩容时不会搬动目录本身，读取方无需同步；容量约3200万条
+    static constexpr int kMaxChunks = 1 << 15;
+    
+    // 只保护 m_ids 和写入路径
+    mutable QReadWriteLock m_lock;
+    QHash<QString, int> m_ids;
+    std::unique_ptr<std::atomic<QString*>[]> m_chunks;
+    std::atomic<int> m_size;
+};
+
+#endif // STRINGPOOL_H
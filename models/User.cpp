@@ -1,48 +1,251 @@
 #include "User.h"
+#include "ObjectPool.h"
+#include "StringPool.h"
 #include <algorithm>
 
 User::User(const QString& id, const QString& name) 
     : m_id(id.isEmpty() ? QUuid::createUuid().toString() : id)
-    , m_name(name) {
+    , m_name(name)
+    , m_removedRows(0)
+    , m_unreportedEdits(0)
+    , m_dataVersion(0)
+    , m_snapshot(std::make_shared<const LedgerSnapshot>(0, nullptr, QVector<LedgerSnapshot::ChunkPtr>()))
+    , m_nextSubscriptionId(1) {
 }
 
+User::~User() {
+    // 记录可能比账本存活更久，断开它们对本账本计数的引用
+    for (const auto& record : m_records) {
+        if (record) {
+            record->setEditCounter(nullptr);
+        }
+    }
+}
+
+bool User::ChangeEvent::isRecordEvent() const {
+    return kind == Kind::RecordsAdded || kind == Kind::RecordModified || kind == Kind::RecordsRemoved;
+}
+
+
 // 记录管理
 void User::addRecord(std::shared_ptr<Record> record) {
-    if (record && !record->getId().isEmpty()) {
+    if (record && !record->getId().isEmpty() && !m_recordIndex.contains(record->getId())) {
+        // 重新添加已删除的记录（撤销删除）
+        if (record->isDeleted()) {
+            record->setStatus(Record::Status::Restored);
+        }
+        int row = m_records.size();
         m_records.append(record);
+        m_recordIndex.insert(record->getId(), row);
+        m_recordDays.append(dayOf(*record));
+        record->setEditCounter(&m_unreportedEdits);
+        insertIntoDateIndex(row);
+        
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::RecordsAdded;
+        event.records.append(record);
+        QSet<const Budget*> seen;
+        applyToBudgets(*record, 1, event.affectedBudgets, seen);
+        observeAmount(record, event);
+        publish(event);
     }
 }
 
 void User::removeRecord(const QString& recordId) {
-    auto it = std::find_if(m_records.begin(), m_records.end(), 
-        [&recordId](const std::shared_ptr<Record>& record) {
-            return record->getId() == recordId;
-        });
+    auto it = m_recordIndex.constFind(recordId);
+    if (it != m_recordIndex.constEnd() && !m_records[it.value()]->isDeleted()) {
+        int row = it.value();
+        auto record = m_records[row];
+        
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::RecordsRemoved;
+        event.records.append(record);
+        QSet<const Budget*> seen;
+        applyToBudgets(*record, -1, event.affectedBudgets, seen);
+        m_anomalyDetector.forget(record->getType(), record->getCategoryId(), record->getAmount());
+        record->markAsDeleted();
+        removeRow(row);
+        publish(event);
+    }
+}
+
+void User::updateRecord(std::shared_ptr<Record> record, const Record& before) {
+    if (!record) return;
+    
+    auto it = m_recordIndex.constFind(record->getId());
+    if (it == m_recordIndex.constEnd()) return;
+    
+    int row = it.value();
+    qint64 day = dayOf(*record);
+    if (day != m_recordDays[row]) {
+        removeFromDateIndex(row);
+        m_recordDays[row] = day;
+        insertIntoDateIndex(row);
+    }
+    record->markEditReported();
     
-    if (it != m_records.end()) {
-        (*it)->markAsDeleted();
+    ChangeEvent event;
+    event.kind = ChangeEvent::Kind::RecordModified;
+    event.records.append(record);
+    event.before = makePooled<Record>(before);
+    QSet<const Budget*> seen;
+    applyToBudgets(before, -1, event.affectedBudgets, seen);
+    applyToBudgets(*record, 1, event.affectedBudgets, seen);
+    // 修改后的金额替换原金额计入画像，修改不触发异常提醒
+    if (before.getType() != record->getType() || before.getCategoryId() != record->getCategoryId()
+        || before.getAmount() != record->getAmount()) {
+        m_anomalyDetector.forget(before.getType(), before.getCategoryId(), before.getAmount());
+        m_anomalyDetector.observe(record->getType(), record->getCategoryId(), record->getAmount());
     }
+    publish(event);
 }
 
-std::shared_ptr<Record> User::getRecord(const QString& recordId) const {
-    auto it = std::find_if(m_records.begin(), m_records.end(),
-        [&recordId](const std::shared_ptr<Record>& record) {
-            return record->getId() == recordId;
-        });
+void User::addRecords(const QVector<std::shared_ptr<Record>>& records) {
+    int firstRow = m_records.size();
+    m_records.reserve(firstRow + records.size());
+    m_recordDays.reserve(firstRow + records.size());
+    m_recordIndex.reserve(firstRow + records.size());
     
-    return (it != m_records.end()) ? *it : nullptr;
+    QVector<DateIndexEntry> newEntries;
+    newEntries.reserve(records.size());
+    
+    ChangeEvent event;
+    event.kind = ChangeEvent::Kind::RecordsAdded;
+    event.records.reserve(records.size());
+    QSet<const Budget*> seen;
+    
+    for (const auto& record : records) {
+        if (!record || record->getId().isEmpty() || m_recordIndex.contains(record->getId())) {
+            continue;
+        }
+        if (record->isDeleted()) {
+            record->setStatus(Record::Status::Restored);
+        }
+        int row = m_records.size();
+        qint64 day = dayOf(*record);
+        m_records.append(record);
+        m_recordIndex.insert(record->getId(), row);
+        m_recordDays.append(day);
+        record->setEditCounter(&m_unreportedEdits);
+        newEntries.append({day, row});
+        event.records.append(record);
+        applyToBudgets(*record, 1, event.affectedBudgets, seen);
+        observeAmount(record, event);
+    }
+    
+    if (newEntries.isEmpty()) {
+        return;
+    }
+    
+    // 新记录先排序，再与已有索引归并一次
+    std::stable_sort(newEntries.begin(), newEntries.end());
+    int middle = m_dateIndex.size();
+    m_dateIndex.append(newEntries);
+    std::inplace_merge(m_dateIndex.begin(), m_dateIndex.begin() + middle, m_dateIndex.end());
+    
+    publish(event);
+}
+
+void User::observeAmount(const std::shared_ptr<Record>& record, ChangeEvent& event) {
+    auto result = m_anomalyDetector.observe(record->getType(), record->getCategoryId(), record->getAmount());
+    if (result.anomalous) {
+        event.anomalies.append({record, result.score, result.typicalAmount});
+    }
+}
+
+void User::removeRecords(const QVector<QString>& recordIds) {
+    ChangeEvent event;
+    event.kind = ChangeEvent::Kind::RecordsRemoved;
+    QSet<const Budget*> seen;
+    
+    for (const auto& recordId : recordIds) {
+        auto it = m_recordIndex.constFind(recordId);
+        if (it != m_recordIndex.constEnd() && !m_records[it.value()]->isDeleted()) {
+            auto record = m_records[it.value()];
+            applyToBudgets(*record, -1, event.affectedBudgets, seen);
+            m_anomalyDetector.forget(record->getType(), record->getCategoryId(), record->getAmount());
+            record->markAsDeleted();
+            event.records.append(record);
+            removeRow(it.value());
+        }
+    }
+    
+    if (!event.records.isEmpty()) {
+        publish(event);
+    }
+}
+
+void User::removeRow(int row) {
+    m_records[row]->setEditCounter(nullptr);
+    m_recordIndex.remove(m_records[row]->getId());
+    m_records[row].reset();
+    ++m_removedRows;
+    // 墓碑多于保留的行时才压缩，每次删除均摊 O(1)
+    if (m_removedRows * 2 > m_records.size()) {
+        compactRecords();
+    }
+}
+
+void User::compactRecords() {
+    // 保留的记录保持原有顺序前移，newRows 为旧下标到新下标的映射
+    QVector<int> newRows(m_records.size(), -1);
+    int kept = 0;
+    for (int row = 0; row < m_records.size(); ++row) {
+        if (!m_records[row]) {
+            continue;
+        }
+        if (kept != row) {
+            m_records[kept] = m_records[row];
+            m_recordDays[kept] = m_recordDays[row];
+            m_recordIndex[m_records[kept]->getId()] = kept;
+        }
+        newRows[row] = kept++;
+    }
+    m_records.resize(kept);
+    m_recordDays.resize(kept);
+    
+    // 日期索引去掉删除的行并改写下标，日期顺序不变
+    int out = 0;
+    for (int i = 0; i < m_dateIndex.size(); ++i) {
+        int row = newRows[m_dateIndex[i].row];
+        if (row >= 0) {
+            m_dateIndex[out++] = DateIndexEntry{m_dateIndex[i].day, row};
+        }
+    }
+    m_dateIndex.resize(out);
+    m_removedRows = 0;
+}
+
+std::shared_ptr<Record> User::getRecord(const QString& recordId) const {
+    auto it = m_recordIndex.constFind(recordId);
+    return (it != m_recordIndex.constEnd()) ? m_records[it.value()] : nullptr;
 }
 
 QVector<std::shared_ptr<Record>> User::getAllRecords() const {
-    return m_records;
+    if (m_removedRows == 0) {
+        return m_records;
+    }
+    
+    QVector<std::shared_ptr<Record>> result;
+    result.reserve(m_records.size() - m_removedRows);
+    for (const auto& record : m_records) {
+        if (record) {
+            result.append(record);
+        }
+    }
+    return result;
 }
 
 QVector<std::shared_ptr<Record>> User::getRecordsByDateRange(const QDate& start, const QDate& end) const {
     QVector<std::shared_ptr<Record>> result;
     
-    for (const auto& record : m_records) {
-        QDate recordDate = record->getDateTime().date();
-        if (recordDate >= start && recordDate <= end && !record->isDeleted()) {
+    auto it = std::lower_bound(m_dateIndex.begin(), m_dateIndex.end(),
+                               DateIndexEntry{start.toJulianDay(), 0});
+    qint64 endDay = end.toJulianDay();
+    
+    for (; it != m_dateIndex.end() && it->day <= endDay; ++it) {
+        const auto& record = m_records[it->row];
+        if (record && !record->isDeleted()) {
             result.append(record);
         }
     }
@@ -50,33 +253,302 @@ QVector<std::shared_ptr<Record>> User::getRecordsByDateRange(const QDate& start,
     return result;
 }
 
+int User::countRecordsInRange(const QDate& start, const QDate& end) const {
+    int count = 0;
+    forEachRecordInRange(start, end, [&count](const Record&) { ++count; });
+    return count;
+}
+
+qint64 User::dayOf(const Record& record) {
+    return record.getDay();
+}
+
+void User::insertIntoDateIndex(int row) {
+    DateIndexEntry entry{m_recordDays[row], row};
+    auto pos = std::upper_bound(m_dateIndex.begin(), m_dateIndex.end(), entry);
+    m_dateIndex.insert(pos, entry);
+}
+
+void User::publish(ChangeEvent event) {
+    event.version = ++m_dataVersion;
+    refreshSnapshot(event);
+    
+    // 复制一份订阅列表，允许监听者在回调中取消订阅
+    const auto listeners = m_listeners;
+    for (const auto& listener : listeners) {
+        listener.second(event);
+    }
+}
+
+std::shared_ptr<const LedgerSnapshot> User::snapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+void User::refreshSnapshot(const ChangeEvent& event) {
+    auto current = std::atomic_load(&m_snapshot);
+    std::shared_ptr<const CategoryHierarchy> hierarchy = current->hierarchyPtr();
+    QVector<LedgerSnapshot::ChunkPtr> chunks;
+    
+    if (event.isRecordEvent() && !current->chunks().isEmpty()) {
+        // 标记受影响日期所在的块
+        const auto& oldChunks = current->chunks();
+        QVector<bool> dirty(oldChunks.size(), false);
+        for (const auto& record : event.records) {
+            dirty[current->chunkFor(dayOf(*record))] = true;
+        }
+        if (event.before) {
+            dirty[current->chunkFor(dayOf(*event.before))] = true;
+        }
+        
+        chunks.reserve(oldChunks.size() + 1);
+        for (int i = 0; i < oldChunks.size(); ++i) {
+            if (!dirty[i]) {
+                chunks.append(oldChunks[i]);
+                continue;
+            }
+            // 第一个块还负责其 minDay 之前的日期，最后一个块负责之后的日期
+            auto begin = i == 0 ? m_dateIndex.cbegin()
+                : std::lower_bound(m_dateIndex.cbegin(), m_dateIndex.cend(),
+                                   DateIndexEntry{oldChunks[i]->minDay, 0});
+            auto end = i + 1 == oldChunks.size() ? m_dateIndex.cend()
+                : std::lower_bound(m_dateIndex.cbegin(), m_dateIndex.cend(),
+                                   DateIndexEntry{oldChunks[i + 1]->minDay, 0});
+            appendChunks(begin, end, chunks);
+        }
+    } else if (event.isRecordEvent() || event.category) {
+        // 分类变化会改变先序编号，整体重建
+        if (event.category) {
+            hierarchy = std::make_shared<const CategoryHierarchy>(m_hierarchy);
+        }
+        appendChunks(m_dateIndex.cbegin(), m_dateIndex.cend(), chunks);
+    } else {
+        // 预算变更不影响账本数据，共享全部数据块
+        chunks = current->chunks();
+    }
+    
+    std::atomic_store(&m_snapshot, std::shared_ptr<const LedgerSnapshot>(
+        std::make_shared<const LedgerSnapshot>(m_dataVersion, hierarchy, chunks)));
+}
+
+void User::appendChunks(QVector<DateIndexEntry>::const_iterator begin,
+                        QVector<DateIndexEntry>::const_iterator end,
+                        QVector<LedgerSnapshot::ChunkPtr>& chunks) const {
+    std::shared_ptr<LedgerChunk> chunk;
+    for (auto it = begin; it != end; ++it) {
+        // 未设置时间的记录不属于任何日期，不进入快照，块的 minDay/maxDay 只取有效日期
+        const Record* record = m_records[it->row].get();
+        if (!record || record->isDeleted() || it->day == Record::kInvalidTimestamp) {
+            continue;
+        }
+        // 块满后在日期切换处分块，保证同一天的记录在同一块中
+        if (chunk && chunk->size() >= LedgerChunk::kChunkRows && it->day != chunk->maxDay) {
+            chunks.append(chunk);
+            chunk.reset();
+        }
+        if (!chunk) {
+            chunk = std::make_shared<LedgerChunk>();
+        }
+        chunk->append(it->day, record->getAmount(), record->getType(),
+                      m_hierarchy.indexOf(record->getCategoryId()), record->getNoteId());
+    }
+    if (chunk) {
+        chunks.append(chunk);
+    }
+}
+
+int User::subscribe(ChangeListener listener) {
+    int subscriptionId = m_nextSubscriptionId++;
+    m_listeners.append(qMakePair(subscriptionId, std::move(listener)));
+    return subscriptionId;
+}
+
+void User::unsubscribe(int subscriptionId) {
+    for (int i = 0; i < m_listeners.size(); ++i) {
+        if (m_listeners[i].first == subscriptionId) {
+            m_listeners.removeAt(i);
+            return;
+        }
+    }
+}
+
+bool User::budgetCoversDay(const Budget& budget, qint64 day) {
+    // 未设置日期的预算视为不限周期
+    if (budget.getStartDate().isValid() && day < budget.getStartDate().toJulianDay()) {
+        return false;
+    }
+    if (budget.getEndDate().isValid() && day > budget.getEndDate().toJulianDay()) {
+        return false;
+    }
+    return true;
+}
+
+void User::indexBudget(const std::shared_ptr<Budget>& budget) {
+    m_budgetsByCategory.insert(budget->getCategoryId(), budget);
+    m_budgetIndexKeys.insert(budget->getId(), budget->getCategoryId());
+}
+
+void User::unindexBudget(const std::shared_ptr<Budget>& budget) {
+    auto it = m_budgetIndexKeys.constFind(budget->getId());
+    if (it != m_budgetIndexKeys.constEnd()) {
+        m_budgetsByCategory.remove(it.value(), budget);
+        m_budgetIndexKeys.remove(budget->getId());
+    }
+}
+
+void User::applyToBudgets(const Record& record, int sign, QVector<std::shared_ptr<Budget>>& affected,
+                          QSet<const Budget*>& seen) {
+    if (!record.isExpense() || record.isDeleted() || m_budgetsByCategory.isEmpty()) {
+        return;
+    }
+    
+    // 沿分类的祖先链查找预算，只触及相关的预算
+    qint64 day = dayOf(record);
+    QString current = record.getCategoryId();
+    int index = m_hierarchy.indexOf(current);
+    while (!current.isEmpty()) {
+        for (auto it = m_budgetsByCategory.constFind(current);
+             it != m_budgetsByCategory.constEnd() && it.key() == current; ++it) {
+            const auto& budget = it.value();
+            if (!budgetCoversDay(*budget, day)) {
+                continue;
+            }
+            if (sign > 0) {
+                budget->addExpense(record.getAmount());
+            } else {
+                budget->removeExpense(record.getAmount());
+            }
+            if (!seen.contains(budget.get())) {
+                seen.insert(budget.get());
+                affected.append(budget);
+            }
+        }
+        
+        if (index < 0) {
+            break;
+        }
+        index = m_hierarchy.parentOf(index);
+        current = index >= 0 ? m_hierarchy.idAt(index) : QString();
+    }
+}
+
+void User::recalculateBudgetUsage(const std::shared_ptr<Budget>& budget) {
+    auto begin = m_dateIndex.begin();
+    auto end = m_dateIndex.end();
+    if (budget->getStartDate().isValid()) {
+        begin = std::lower_bound(begin, end, DateIndexEntry{budget->getStartDate().toJulianDay(), 0});
+    }
+    if (budget->getEndDate().isValid()) {
+        end = std::upper_bound(begin, end, DateIndexEntry{budget->getEndDate().toJulianDay(), 0});
+    }
+    
+    double used = 0.0;
+    for (auto it = begin; it != end; ++it) {
+        const auto& record = m_records[it->row];
+        if (record && record->isExpense() && !record->isDeleted()
+            && (record->getCategoryId() == budget->getCategoryId()
+                || m_hierarchy.contains(budget->getCategoryId(), record->getCategoryId()))) {
+            used += record->getAmount();
+        }
+    }
+    
+    budget->setUsedAmount(used);
+    budget->checkAndUpdateStatus();
+}
+
+void User::removeFromDateIndex(int row) {
+    auto range = std::equal_range(m_dateIndex.begin(), m_dateIndex.end(),
+                                  DateIndexEntry{m_recordDays[row], row});
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->row == row) {
+            m_dateIndex.erase(it);
+            return;
+        }
+    }
+}
+
 // 分类管理
 void User::addCategory(std::shared_ptr<Category> category) {
-    if (category && !category->getId().isEmpty()) {
+    if (category && !category->getId().isEmpty() && !m_categoryIndex.contains(category->getId())) {
         m_categories.append(category);
+        m_categoryIndex.insert(category->getId(), category);
+        rebuildCategoryHierarchy();
+        
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::CategoryAdded;
+        event.category = category;
+        publish(event);
     }
 }
 
 void User::removeCategory(const QString& categoryId) {
-    m_categories.erase(
-        std::remove_if(m_categories.begin(), m_categories.end(),
-            [&categoryId](const std::shared_ptr<Category>& category) {
-                return category->getId() == categoryId;
-            }),
-        m_categories.end()
-    );
-}
-
-std::shared_ptr<Category> User::getCategory(const QString& categoryId) const {
+    // 该分类的预算随分类一起删除，各自发布 BudgetRemoved
+    if (m_categoryIndex.contains(categoryId)) {
+        for (const auto& budget : getBudgets(categoryId)) {
+            removeBudget(budget->getId());
+        }
+    }
+    
     auto it = std::find_if(m_categories.begin(), m_categories.end(),
         [&categoryId](const std::shared_ptr<Category>& category) {
             return category->getId() == categoryId;
         });
     
-    return (it != m_categories.end()) ? *it : nullptr;
+    if (it != m_categories.end()) {
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::CategoryRemoved;
+        event.category = *it;
+        m_categoryIndex.remove(categoryId);
+        m_categories.erase(it);
+        rebuildCategoryHierarchy();
+        publish(event);
+    }
 }
 
-QVector<std::shared_ptr<Category>> User::getAllCategories() const {
+void User::updateCategory(std::shared_ptr<Category> category) {
+    if (!category) return;
+    
+    // 父分类或名称可能变化
+    rebuildCategoryHierarchy();
+    
+    ChangeEvent event;
+    event.kind = ChangeEvent::Kind::CategoryModified;
+    event.category = category;
+    publish(event);
+}
+
+std::shared_ptr<Category> User::getCategory(const QString& categoryId) const {
+    return m_categoryIndex.value(categoryId);
+}
+
+QString User::getCategoryDisplayPath(const QString& categoryId) const {
+    return m_hierarchy.displayPath(categoryId);
+}
+
+void User::rebuildCategoryHierarchy() {
+    // 子树成员变化的分类上的预算覆盖的记录随之变化，只重新累计这些预算
+    QHash<QString, QVector<QString>> budgetSubtrees;
+    for (const auto& budget : m_budgets) {
+        if (!budgetSubtrees.contains(budget->getCategoryId())) {
+            budgetSubtrees.insert(budget->getCategoryId(), m_hierarchy.subtreeIds(budget->getCategoryId()));
+        }
+    }
+    
+    m_hierarchy.rebuild(m_categories);
+    
+    QSet<QString> changed;
+    for (auto it = budgetSubtrees.constBegin(); it != budgetSubtrees.constEnd(); ++it) {
+        if (m_hierarchy.subtreeIds(it.key()) != it.value()) {
+            changed.insert(it.key());
+        }
+    }
+    for (const auto& budget : m_budgets) {
+        if (changed.contains(budget->getCategoryId())) {
+            recalculateBudgetUsage(budget);
+        }
+    }
+}
+
+const QVector<std::shared_ptr<Category>>& User::getAllCategories() const {
     return m_categories;
 }
 
@@ -96,57 +568,94 @@ QVector<std::shared_ptr<Category>> User::getTopLevelCategories() const {
 void User::addBudget(std::shared_ptr<Budget> budget) {
     if (budget && !budget->getId().isEmpty()) {
         m_budgets.append(budget);
+        indexBudget(budget);
+        recalculateBudgetUsage(budget);
+        
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::BudgetAdded;
+        event.budget = budget;
+        publish(event);
     }
 }
 
 void User::removeBudget(const QString& budgetId) {
-    m_budgets.erase(
-        std::remove_if(m_budgets.begin(), m_budgets.end(),
-            [&budgetId](const std::shared_ptr<Budget>& budget) {
-                return budget->getId() == budgetId;
-            }),
-        m_budgets.end()
-    );
-}
-
-std::shared_ptr<Budget> User::getBudget(const QString& categoryId) const {
     auto it = std::find_if(m_budgets.begin(), m_budgets.end(),
-        [&categoryId](const std::shared_ptr<Budget>& budget) {
-            return budget->getCategoryId() == categoryId;
+        [&budgetId](const std::shared_ptr<Budget>& budget) {
+            return budget->getId() == budgetId;
         });
     
-    return (it != m_budgets.end()) ? *it : nullptr;
+    if (it != m_budgets.end()) {
+        ChangeEvent event;
+        event.kind = ChangeEvent::Kind::BudgetRemoved;
+        event.budget = *it;
+        unindexBudget(*it);
+        m_budgets.erase(it);
+        publish(event);
+    }
 }
 
-QVector<std::shared_ptr<Budget>> User::getAllBudgets() const {
-    return m_budgets;
+void User::updateBudget(std::shared_ptr<Budget> budget) {
+    if (!budget) return;
+    
+    // 分类或周期可能变化，重建索引并重新累计
+    unindexBudget(budget);
+    indexBudget(budget);
+    recalculateBudgetUsage(budget);
+    
+    ChangeEvent event;
+    event.kind = ChangeEvent::Kind::BudgetModified;
+    event.budget = budget;
+    publish(event);
 }
 
-// 财务计算
-double User::getTotalIncome(const QDate& start, const QDate& end) const {
-    double total = 0.0;
-    auto records = getRecordsByDateRange(start, end);
+std::shared_ptr<Budget> User::getBudget(const QString& categoryId) const {
+    std::shared_ptr<Budget> first;
+    qint64 today = QDate::currentDate().toJulianDay();
     
-    for (const auto& record : records) {
-        if (record->isIncome()) {
-            total += record->getAmount();
+    for (auto it = m_budgetsByCategory.constFind(categoryId);
+         it != m_budgetsByCategory.constEnd() && it.key() == categoryId; ++it) {
+        if (budgetCoversDay(*it.value(), today)) {
+            return it.value();
+        }
+        if (!first) {
+            first = it.value();
         }
     }
     
-    return total;
+    return first;
 }
 
-double User::getTotalExpense(const QDate& start, const QDate& end) const {
-    double total = 0.0;
-    auto records = getRecordsByDateRange(start, end);
+QVector<std::shared_ptr<Budget>> User::getBudgets(const QString& categoryId) const {
+    return m_budgetsByCategory.values(categoryId);
+}
+
+QVector<std::shared_ptr<Budget>> User::getBudgetsForDate(const QString& categoryId, const QDate& date) const {
+    QVector<std::shared_ptr<Budget>> result;
+    qint64 day = date.toJulianDay();
     
-    for (const auto& record : records) {
-        if (record->isExpense()) {
-            total += record->getAmount();
+    for (auto it = m_budgetsByCategory.constFind(categoryId);
+         it != m_budgetsByCategory.constEnd() && it.key() == categoryId; ++it) {
+        if (budgetCoversDay(*it.value(), day)) {
+            result.append(it.value());
         }
     }
     
-    return total;
+    return result;
+}
+
+const QVector<std::shared_ptr<Budget>>& User::getAllBudgets() const {
+    return m_budgets;
+}
+
+// 财务计算
+double User::getTotalIncome(const QDate& start, const QDate& end) const {
+    Q_ASSERT_X(!hasUnreportedEdits(), "User::getTotalIncome", "record modified in place without updateRecord");
+    return snapshot()->totalInRange(start, end, Record::Type::Income);
+}
+
+double User::getTotalExpense(const QDate& start, const QDate& end) const {
+    Q_ASSERT_X(!hasUnreportedEdits(), "User::getTotalExpense", "record modified in place without updateRecord");
+    return snapshot()->totalInRange(start, end, Record::Type::Expense);
 }
 
 double User::getBalance(const QDate& start, const QDate& end) const {
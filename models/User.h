@@ -3,14 +3,65 @@
 
 #include <QString>
 #include <QVector>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QPair>
+#include <algorithm>
 #include <memory>
+#include <functional>
 #include "Record.h"
 #include "Category.h"
+#include "CategoryHierarchy.h"
 #include "Budget.h"
+#include "LedgerSnapshot.h"
+#include "AmountAnomalyDetector.h"
 
+// 以下接口只能在写线程（GUI线程）调用；
+// 其他线程通过 snapshot() 取得不可变快照读取账本
 class User {
 public:
+    // 金额异常：新记录的金额与同分类以往金额相比明显偏大
+    struct Anomaly {
+        std::shared_ptr<Record> record;
+        double score = 0.0;
+        double typicalAmount = 0.0;
+    };
+    
+    // 数据变更事件，供报表、预算、提醒和界面做增量更新
+    struct ChangeEvent {
+        enum class Kind {
+            RecordsAdded,
+            RecordModified,
+            RecordsRemoved,
+            CategoryAdded,
+            CategoryModified,
+            CategoryRemoved,
+            BudgetAdded,
+            BudgetModified,
+            BudgetRemoved
+        };
+        
+        Kind kind = Kind::RecordsAdded;
+        QVector<std::shared_ptr<Record>> records;  // 受影响的记录（变更后的值）
+        std::shared_ptr<const Record> before;      // RecordModified: 变更前的值
+        std::shared_ptr<Category> category;
+        std::shared_ptr<Budget> budget;
+        QVector<std::shared_ptr<Budget>> affectedBudgets; // 记录事件：已用金额随之变化的预算
+        QVector<Anomaly> anomalies;                // RecordsAdded: 金额明显偏离同分类以往金额的新记录
+        quint64 version = 0;                       // 变更后的数据版本
+        
+        bool isRecordEvent() const;
+    };
+    
+    using ChangeListener = std::function<void(const ChangeEvent&)>;
+    
     User(const QString& id = QString(), const QString& name = QString());
+    ~User();
+    
+    // 账本中的记录引用本对象的未登记修改计数，不可复制
+    User(const User&) = delete;
+    User& operator=(const User&) = delete;
     
     // Getter和Setter
     QString getId() const { return m_id; }
@@ -23,36 +74,140 @@ public:
     // 记录管理
     void addRecord(std::shared_ptr<Record> record);
     void removeRecord(const QString& recordId);
+    void updateRecord(std::shared_ptr<Record> record, const Record& before); // 记录被原地修改后调用
+    
+    // 批量操作：一次性扩容、合并日期索引，只产生一次数据版本变更
+    void addRecords(const QVector<std::shared_ptr<Record>>& records);
+    void removeRecords(const QVector<QString>& recordIds);
+    
     std::shared_ptr<Record> getRecord(const QString& recordId) const;
+    // 按加入顺序返回未删除的记录；没有待压缩的已删除行时与内部数组共享数据，不逐条复制
     QVector<std::shared_ptr<Record>> getAllRecords() const;
     QVector<std::shared_ptr<Record>> getRecordsByDateRange(const QDate& start, const QDate& end) const;
     
+    // 按日期顺序只读遍历范围内未删除的记录，不分配内存也不增加引用计数
+    template <typename Visitor>
+    void forEachRecordInRange(const QDate& start, const QDate& end, Visitor&& visit) const;
+    int countRecordsInRange(const QDate& start, const QDate& end) const;
+    
     // 分类管理
     void addCategory(std::shared_ptr<Category> category);
     void removeCategory(const QString& categoryId);
+    void updateCategory(std::shared_ptr<Category> category);
     std::shared_ptr<Category> getCategory(const QString& categoryId) const;
-    QVector<std::shared_ptr<Category>> getAllCategories() const;
+    const QVector<std::shared_ptr<Category>>& getAllCategories() const;
     QVector<std::shared_ptr<Category>> getTopLevelCategories() const;
+    const CategoryHierarchy& getCategoryHierarchy() const { return m_hierarchy; }
+    QString getCategoryDisplayPath(const QString& categoryId) const;
     
     // 预算管理
     void addBudget(std::shared_ptr<Budget> budget);
     void removeBudget(const QString& budgetId);
-    std::shared_ptr<Budget> getBudget(const QString& categoryId) const;
-    QVector<std::shared_ptr<Budget>> getAllBudgets() const;
+    void updateBudget(std::shared_ptr<Budget> budget);
+    std::shared_ptr<Budget> getBudget(const QString& categoryId) const; // 优先返回当前周期内的预算
+    QVector<std::shared_ptr<Budget>> getBudgets(const QString& categoryId) const;
+    QVector<std::shared_ptr<Budget>> getBudgetsForDate(const QString& categoryId, const QDate& date) const;
+    const QVector<std::shared_ptr<Budget>>& getAllBudgets() const;
+    // 预算周期是否包含该日（儒略日），未设置起止日期的一端不限
+    static bool budgetCoversDay(const Budget& budget, qint64 day);
+    
+    // 是否有记录被原地修改而尚未调用 updateRecord；此时快照、预算和索引落后于记录，O(1)
+    bool hasUnreportedEdits() const { return m_unreportedEdits != 0; }
     
-    // 财务计算
+    // 财务计算：在最新快照的列数据上求和，记录原地修改后须先调用 updateRecord（调试构建中断言）
     double getTotalIncome(const QDate& start, const QDate& end) const;
     double getTotalExpense(const QDate& start, const QDate& end) const;
     double getBalance(const QDate& start, const QDate& end) const;
     
+    // 新增记录（含批量导入）的金额异常检测；删除或修改记录时撤销原金额（见 AmountAnomalyDetector::forget），
+    // 画像由 DataStorageService::saveAnomalyDetector / loadAnomalyDetector 保存和恢复
+    const AmountAnomalyDetector& getAnomalyDetector() const { return m_anomalyDetector; }
+    void setAnomalyDetector(const AmountAnomalyDetector& detector) { m_anomalyDetector = detector; }
+    
+    // 数据版本号，每次数据变更（含批量操作）递增一次
+    quint64 getDataVersion() const { return m_dataVersion; }
+    
+    // 当前数据版本的账本快照，可在任意线程无锁读取
+    std::shared_ptr<const LedgerSnapshot> snapshot() const;
+    
+    // 变更订阅
+    int subscribe(ChangeListener listener);
+    void unsubscribe(int subscriptionId);
+    
 private:
+    // 日期索引项：按日期（儒略日）排序的记录下标
+    struct DateIndexEntry {
+        qint64 day;
+        int row;
+        
+        bool operator<(const DateIndexEntry& other) const { return day < other.day; }
+    };
+    
+    static qint64 dayOf(const Record& record);
+    void insertIntoDateIndex(int row);
+    void removeFromDateIndex(int row);
+    // 删除记录时立即释放其ID（可以重新添加），行先置空留作墓碑；
+    // 墓碑多于保留的行时 compactRecords 一次遍历移除全部墓碑
+    void removeRow(int row);
+    void compactRecords();
+    void publish(ChangeEvent event);
+    void observeAmount(const std::shared_ptr<Record>& record, ChangeEvent& event);
+    
+    // 快照维护：只重建受变更影响的数据块，其余块与旧版本共享
+    void refreshSnapshot(const ChangeEvent& event);
+    void appendChunks(QVector<DateIndexEntry>::const_iterator begin,
+                      QVector<DateIndexEntry>::const_iterator end,
+                      QVector<LedgerSnapshot::ChunkPtr>& chunks) const;
+    
+    // 分类结构变化后重建层级索引，并重新累计子树成员发生变化的预算
+    void rebuildCategoryHierarchy();
+    
+    // 预算已用金额维护：按（分类子树，预算周期）增量累计支出
+    void indexBudget(const std::shared_ptr<Budget>& budget);
+    void unindexBudget(const std::shared_ptr<Budget>& budget);
+    // seen 与 affected 同步，按预算去重
+    void applyToBudgets(const Record& record, int sign, QVector<std::shared_ptr<Budget>>& affected,
+                        QSet<const Budget*>& seen);
+    void recalculateBudgetUsage(const std::shared_ptr<Budget>& budget);
+    
+
     QString m_id;
     QString m_name;
     QString m_email;
     
-    QVector<std::shared_ptr<Record>> m_records;
+    QVector<std::shared_ptr<Record>> m_records; // 已删除的行置空，压缩前保留下标
     QVector<std::shared_ptr<Category>> m_categories;
+    QHash<QString, std::shared_ptr<Category>> m_categoryIndex; // 分类ID -> 分类
+    CategoryHierarchy m_hierarchy;
     QVector<std::shared_ptr<Budget>> m_budgets;
+    QMultiHash<QString, std::shared_ptr<Budget>> m_budgetsByCategory; // 分类ID -> 预算
+    QHash<QString, QString> m_budgetIndexKeys;                         // 预算ID -> 索引时的分类ID
+    AmountAnomalyDetector m_anomalyDetector;
+    
+    QHash<QString, int> m_recordIndex;       // 记录ID -> m_records下标
+    int m_removedRows;                       // m_records 中尚未压缩的墓碑（空指针）数
+    int m_unreportedEdits;                   // 原地修改后尚未调用 updateRecord 的记录数
+    QVector<qint64> m_recordDays;            // 每条记录在日期索引中的日期
+    QVector<DateIndexEntry> m_dateIndex;     // 按日期升序
+    quint64 m_dataVersion;
+    std::shared_ptr<const LedgerSnapshot> m_snapshot; // 通过 std::atomic_load/atomic_store 访问
+    
+    QVector<QPair<int, ChangeListener>> m_listeners;
+    int m_nextSubscriptionId;
 };
 
+template <typename Visitor>
+void User::forEachRecordInRange(const QDate& start, const QDate& end, Visitor&& visit) const {
+    auto it = std::lower_bound(m_dateIndex.cbegin(), m_dateIndex.cend(),
+                               DateIndexEntry{start.toJulianDay(), 0});
+    qint64 endDay = end.toJulianDay();
+    
+    for (; it != m_dateIndex.cend() && it->day <= endDay; ++it) {
+        const Record* record = m_records[it->row].get();
+        if (record && !record->isDeleted()) {
+            visit(*record);
+        }
+    }
+}
+
 #endif // USER_H
\ No newline at end of file
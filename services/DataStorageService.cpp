@@ -1,5 +1,108 @@
 #include "DataStorageService.h"
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace {
+
+// 提醒归档文件：每行一条 JSON，只追加不改写
+const QString kReminderArchiveFile = "reminders_archive.jsonl";
+// 定时提醒计划：整体改写
+const QString kScheduledRemindersFile = "scheduled_reminders.json";
+// 金额异常检测画像
+const QString kAnomalyProfilesFile = "anomaly_profiles.json";
+
+QJsonObject reminderToJson(const ReminderService::Reminder& reminder) {
+    QJsonObject object;
+    object["id"] = reminder.id;
+    object["type"] = static_cast<int>(reminder.type);
+    object["title"] = reminder.title;
+    object["message"] = reminder.message;
+    object["timestamp"] = reminder.timestamp.toMSecsSinceEpoch();
+    object["isRead"] = reminder.isRead;
+    if (reminder.data.isValid()) {
+        object["data"] = reminder.data.toString();
+    }
+    return object;
+}
+
+ReminderService::Reminder reminderFromJson(const QJsonObject& object) {
+    ReminderService::Reminder reminder;
+    reminder.id = object.value("id").toString();
+    reminder.type = static_cast<ReminderService::ReminderType>(object.value("type").toInt());
+    reminder.title = object.value("title").toString();
+    reminder.message = object.value("message").toString();
+    reminder.timestamp = QDateTime::fromMSecsSinceEpoch(object.value("timestamp").toInteger());
+    reminder.isRead = object.value("isRead").toBool();
+    if (object.contains("data")) {
+        reminder.data = object.value("data").toString();
+    }
+    return reminder;
+}
+
+QJsonObject scheduledToJson(const ReminderService::ScheduledReminder& reminder) {
+    QJsonObject object;
+    object["id"] = reminder.id;
+    object["type"] = static_cast<int>(reminder.type);
+    object["title"] = reminder.title;
+    object["message"] = reminder.message;
+    object["dueTime"] = reminder.dueTime.toMSecsSinceEpoch();
+    object["firstDueTime"] = reminder.firstDueTime.toMSecsSinceEpoch();
+    object["occurrence"] = reminder.occurrence;
+    object["repeatDays"] = reminder.repeatDays;
+    object["repeatMonths"] = reminder.repeatMonths;
+    return object;
+}
+
+ReminderService::ScheduledReminder scheduledFromJson(const QJsonObject& object) {
+    ReminderService::ScheduledReminder reminder;
+    reminder.id = object.value("id").toString();
+    reminder.type = static_cast<ReminderService::ReminderType>(object.value("type").toInt());
+    reminder.title = object.value("title").toString();
+    reminder.message = object.value("message").toString();
+    reminder.dueTime = QDateTime::fromMSecsSinceEpoch(object.value("dueTime").toInteger());
+    reminder.firstDueTime = QDateTime::fromMSecsSinceEpoch(object.value("firstDueTime").toInteger());
+    reminder.occurrence = object.value("occurrence").toInt();
+    reminder.repeatDays = object.value("repeatDays").toInt();
+    reminder.repeatMonths = object.value("repeatMonths").toInt();
+    return reminder;
+}
+
+QJsonObject profileToJson(const AmountAnomalyDetector::Profile& profile) {
+    QJsonObject object;
+    object["count"] = qint64(profile.count);
+    object["mean"] = profile.mean;
+    object["m2"] = profile.m2;
+    object["median"] = profile.median;
+    object["mad"] = profile.mad;
+    QJsonArray warmup;
+    for (double amount : profile.warmup) {
+        warmup.append(amount);
+    }
+    object["warmup"] = warmup;
+    return object;
+}
+
+AmountAnomalyDetector::Profile profileFromJson(const QJsonObject& object) {
+    AmountAnomalyDetector::Profile profile;
+    profile.count = quint64(std::max<qint64>(0, object.value("count").toInteger()));
+    profile.mean = object.value("mean").toDouble();
+    profile.m2 = object.value("m2").toDouble();
+    profile.median = object.value("median").toDouble();
+    profile.mad = object.value("mad").toDouble();
+    const QJsonArray warmup = object.value("warmup").toArray();
+    for (const QJsonValue& amount : warmup) {
+        profile.warmup.append(amount.toDouble());
+    }
+    return profile;
+}
+
+} // namespace
 
 class DataStorageService::Impl {
 public:
@@ -7,6 +110,38 @@ public:
     
     Impl() {
     }
+    
+    // 每个用户的数据放在数据目录下以用户ID命名的子目录中，写入时按需创建目录
+    QString userFilePath(const QString& userId, const QString& fileName, bool create) const {
+        QDir userDir(QDir(dbPath).filePath(userId));
+        if (create && !userDir.mkpath(".")) {
+            return QString();
+        }
+        return userDir.filePath(fileName);
+    }
+    
+    // 先写临时文件再替换，写入中断时保留上一次保存的内容
+    bool writeDocument(const QString& path, const QJsonDocument& document, QString& error) const {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            error = file.errorString();
+            return false;
+        }
+        QByteArray data = document.toJson(QJsonDocument::Compact);
+        if (file.write(data) != data.size() || !file.commit()) {
+            error = file.errorString();
+            return false;
+        }
+        return true;
+    }
+    
+    QJsonDocument readDocument(const QString& path) const {
+        QFile file(path);
+        if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+            return QJsonDocument();
+        }
+        return QJsonDocument::fromJson(file.readAll());
+    }
 };
 
 DataStorageService::DataStorageService(QObject *parent)
@@ -109,6 +244,102 @@ bool DataStorageService::deleteBudget(const QString& budgetId) {
     return true;
 }
 
+bool DataStorageService::archiveReminder(const ReminderService::Reminder& reminder, const QString& userId) {
+    if (reminder.id.isEmpty()) return false;
+    
+    QFile file(m_impl->userFilePath(userId, kReminderArchiveFile, true));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        emit errorOccurred(QString("提醒归档失败: %1").arg(file.errorString()));
+        return false;
+    }
+    QByteArray line = QJsonDocument(reminderToJson(reminder)).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (file.write(line) != line.size()) {
+        emit errorOccurred(QString("提醒归档失败: %1").arg(file.errorString()));
+        return false;
+    }
+    emit dataSaved("reminders_archive");
+    return true;
+}
+
+QVector<ReminderService::Reminder> DataStorageService::loadArchivedReminders(const QString& userId) {
+    QVector<ReminderService::Reminder> reminders;
+    QFile file(m_impl->userFilePath(userId, kReminderArchiveFile, false));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return reminders;
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray& line : lines) {
+        // 跳过空行和写入中断留下的不完整行
+        QJsonObject object = QJsonDocument::fromJson(line.trimmed()).object();
+        if (object.value("id").toString().isEmpty()) {
+            continue;
+        }
+        reminders.append(reminderFromJson(object));
+    }
+    emit dataLoaded("reminders_archive");
+    return reminders;
+}
+
+bool DataStorageService::saveScheduledReminders(const QVector<ReminderService::ScheduledReminder>& reminders,
+                                                const QString& userId) {
+    QJsonArray array;
+    for (const auto& reminder : reminders) {
+        array.append(scheduledToJson(reminder));
+    }
+    QString error;
+    if (!m_impl->writeDocument(m_impl->userFilePath(userId, kScheduledRemindersFile, true), QJsonDocument(array), error)) {
+        emit errorOccurred(QString("定时提醒保存失败: %1").arg(error));
+        return false;
+    }
+    emit dataSaved("scheduled_reminders");
+    return true;
+}
+
+QVector<ReminderService::ScheduledReminder> DataStorageService::loadScheduledReminders(const QString& userId) {
+    QVector<ReminderService::ScheduledReminder> reminders;
+    const QJsonArray array = m_impl->readDocument(m_impl->userFilePath(userId, kScheduledRemindersFile, false)).array();
+    reminders.reserve(array.size());
+    for (const QJsonValue& value : array) {
+        reminders.append(scheduledFromJson(value.toObject()));
+    }
+    emit dataLoaded("scheduled_reminders");
+    return reminders;
+}
+
+bool DataStorageService::saveAnomalyDetector(const AmountAnomalyDetector& detector, const QString& userId) {
+    QJsonObject profiles;
+    for (auto it = detector.profiles().constBegin(); it != detector.profiles().constEnd(); ++it) {
+        profiles[it.key()] = profileToJson(it.value());
+    }
+    QJsonObject object;
+    object["threshold"] = detector.threshold();
+    object["profiles"] = profiles;
+    QString error;
+    if (!m_impl->writeDocument(m_impl->userFilePath(userId, kAnomalyProfilesFile, true), QJsonDocument(object), error)) {
+        emit errorOccurred(QString("金额画像保存失败: %1").arg(error));
+        return false;
+    }
+    emit dataSaved("anomaly_profiles");
+    return true;
+}
+
+AmountAnomalyDetector DataStorageService::loadAnomalyDetector(const QString& userId) {
+    AmountAnomalyDetector detector;
+    const QJsonObject object = m_impl->readDocument(m_impl->userFilePath(userId, kAnomalyProfilesFile, false)).object();
+    if (object.contains("threshold")) {
+        detector.setThreshold(object.value("threshold").toDouble());
+    }
+    QHash<QString, AmountAnomalyDetector::Profile> profiles;
+    const QJsonObject profileObjects = object.value("profiles").toObject();
+    for (const QString& key : profileObjects.keys()) {
+        profiles.insert(key, profileFromJson(profileObjects.value(key).toObject()));
+    }
+    detector.setProfiles(profiles);
+    emit dataLoaded("anomaly_profiles");
+    return detector;
+}
+
 bool DataStorageService::exportToCSV(const QString& filePath, const QDate& startDate, const QDate& endDate) {
     // TODO: 实现
     return true;
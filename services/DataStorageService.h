@@ -8,6 +8,7 @@
 #include "../models/Record.h"
 #include "../models/Category.h"
 #include "../models/Budget.h"
+#include "ReminderService.h"
 
 class DataStorageService : public QObject {
     Q_OBJECT
@@ -43,6 +44,18 @@ public:
     QVector<std::shared_ptr<Budget>> loadBudgets(const QString& userId);
     bool deleteBudget(const QString& budgetId);
     
+    // 提醒归档：提醒服务内存中放不下的旧提醒追加写入用户目录下的归档文件，按归档顺序读回
+    bool archiveReminder(const ReminderService::Reminder& reminder, const QString& userId);
+    QVector<ReminderService::Reminder> loadArchivedReminders(const QString& userId);
+    
+    // 定时提醒计划整体保存和读取，没有保存过时返回空列表
+    bool saveScheduledReminders(const QVector<ReminderService::ScheduledReminder>& reminders, const QString& userId);
+    QVector<ReminderService::ScheduledReminder> loadScheduledReminders(const QString& userId);
+    
+    // 金额异常检测画像，没有保存过时返回未学习任何金额的检测器
+    bool saveAnomalyDetector(const AmountAnomalyDetector& detector, const QString& userId);
+    AmountAnomalyDetector loadAnomalyDetector(const QString& userId);
+    
     // 数据导出
     bool exportToCSV(const QString& filePath, const QDate& startDate, const QDate& endDate);
     bool exportToJSON(const QString& filePath);
@@ -0,0 +1,185 @@
+#include "LedgerAggregator.h"
+#include <QThreadPool>
+#include <QSemaphore>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+void resetResult(LedgerAggregator::Result& result, qint64 firstDay, int dayCount, int categoryCount) {
+    result.firstDay = firstDay;
+    result.dailyIncome.fill(0.0, dayCount);
+    result.dailyExpense.fill(0.0, dayCount);
+    result.categoryIncome.fill(0.0, categoryCount);
+    result.categoryExpense.fill(0.0, categoryCount);
+}
+
+// 累计一个数据块中落在范围内的行
+void accumulateChunk(const LedgerChunk& chunk, qint64 startDay, qint64 endDay,
+                     LedgerAggregator::Result& result) {
+    int begin = 0;
+    int end = 0;
+    chunk.rowRange(startDay, endDay, begin, end);
+    
+    const quint8 income = static_cast<quint8>(Record::Type::Income);
+    for (int row = begin; row < end; ++row) {
+        int dayIndex = int(chunk.days[row] - result.firstDay);
+        double amount = chunk.amounts[row];
+        int category = chunk.categories[row];
+        if (chunk.kinds[row] == income) {
+            result.totalIncome += amount;
+            result.dailyIncome[dayIndex] += amount;
+            (category >= 0 ? result.categoryIncome[category] : result.unknownIncome) += amount;
+        } else {
+            result.totalExpense += amount;
+            result.dailyExpense[dayIndex] += amount;
+            (category >= 0 ? result.categoryExpense[category] : result.unknownExpense) += amount;
+        }
+    }
+    result.transactionCount += end - begin;
+}
+
+void addInto(QVector<double>& target, const QVector<double>& source) {
+    for (int i = 0; i < source.size(); ++i) {
+        target[i] += source[i];
+    }
+}
+
+} // namespace
+
+void LedgerAggregator::Result::merge(const Result& other) {
+    addInto(dailyIncome, other.dailyIncome);
+    addInto(dailyExpense, other.dailyExpense);
+    addInto(categoryIncome, other.categoryIncome);
+    addInto(categoryExpense, other.categoryExpense);
+    unknownIncome += other.unknownIncome;
+    unknownExpense += other.unknownExpense;
+    totalIncome += other.totalIncome;
+    totalExpense += other.totalExpense;
+    transactionCount += other.transactionCount;
+}
+
+LedgerAggregator::Result LedgerAggregator::aggregate(const LedgerSnapshot& snapshot,
+                                                     const QDate& startDate, const QDate& endDate,
+                                                     QThreadPool* pool, int maxWorkers,
+                                                     const std::function<bool()>& canceled) {
+    Result result;
+    const int categoryCount = snapshot.hierarchy().size();
+    resetResult(result, startDate.toJulianDay(), 0, categoryCount);
+    
+    // 无效日期的儒略日是极小值，参与相减会使天数溢出
+    const auto& chunks = snapshot.chunks();
+    qint64 startDay = startDate.toJulianDay();
+    qint64 endDay = endDate.toJulianDay();
+    if (!startDate.isValid() || !endDate.isValid() || chunks.isEmpty() || startDay > endDay) {
+        return result;
+    }
+    
+    // 每日数组只覆盖快照中实际有数据的日期
+    int firstChunk = snapshot.chunkFor(startDay);
+    int lastChunk = snapshot.chunkFor(endDay);
+    qint64 firstDay = std::max(startDay, chunks[firstChunk]->minDay);
+    qint64 lastDay = std::min(endDay, chunks[lastChunk]->maxDay);
+    if (firstDay > lastDay) {
+        return result;
+    }
+    const int dayCount = int(lastDay - firstDay + 1);
+    resetResult(result, firstDay, dayCount, categoryCount);
+    
+    if (!pool) {
+        pool = QThreadPool::globalInstance();
+    }
+    int chunkCount = lastChunk - firstChunk + 1;
+    int workers = maxWorkers > 0 ? maxWorkers : pool->maxThreadCount();
+    workers = std::min(workers, chunkCount);
+    
+    std::atomic<int> nextChunk(firstChunk);
+    auto work = [&](Result& partial) {
+        for (int c = nextChunk.fetch_add(1); c <= lastChunk; c = nextChunk.fetch_add(1)) {
+            if (canceled && canceled()) {
+                return;
+            }
+            accumulateChunk(*chunks[c], firstDay, lastDay, partial);
+        }
+    };
+    
+    if (workers <= 1 || chunkCount < kMinParallelChunks) {
+        work(result);
+        return result;
+    }
+    
+    // 只占用线程池中的空闲线程，线程池繁忙时由调用线程完成剩余数据块
+    QVector<Result> partials(workers - 1);
+    QSemaphore finished;
+    int helpers = 0;
+    for (int i = 0; i < workers - 1; ++i) {
+        Result* partial = &partials[i];
+        bool started = pool->tryStart([&, partial]() {
+            resetResult(*partial, firstDay, dayCount, categoryCount);
+            work(*partial);
+            finished.release();
+        });
+        if (!started) {
+            break;
+        }
+        ++helpers;
+    }
+    
+    work(result);
+    finished.acquire(helpers);
+    for (int i = 0; i < helpers; ++i) {
+        result.merge(partials[i]);
+    }
+    
+    return result;
+}
+
+QVector<double> LedgerAggregator::CategoryDaily::prefixSums(int firstCategory, int endCategory) const {
+    QVector<double> prefix(dayCount + 1, 0.0);
+    firstCategory = std::max(0, firstCategory);
+    endCategory = std::min(endCategory, categoryCount);
+    for (int category = firstCategory; category < endCategory; ++category) {
+        const double* row = values.constData() + category * dayCount;
+        for (int day = 0; day < dayCount; ++day) {
+            prefix[day + 1] += row[day];
+        }
+    }
+    for (int day = 0; day < dayCount; ++day) {
+        prefix[day + 1] += prefix[day];
+    }
+    return prefix;
+}
+
+LedgerAggregator::CategoryDaily LedgerAggregator::categoryDaily(const LedgerSnapshot& snapshot,
+                                                                const QDate& startDate, const QDate& endDate,
+                                                                Record::Type type) {
+    CategoryDaily result;
+    result.firstDay = startDate.toJulianDay();
+    result.categoryCount = snapshot.hierarchy().size();
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return result;
+    }
+    
+    // 与 aggregate 相同，只分配快照中实际有数据的日期
+    const auto& chunks = snapshot.chunks();
+    if (chunks.isEmpty()) {
+        return result;
+    }
+    qint64 firstDay = std::max(startDate.toJulianDay(), chunks[snapshot.chunkFor(startDate.toJulianDay())]->minDay);
+    qint64 lastDay = std::min(endDate.toJulianDay(), chunks[snapshot.chunkFor(endDate.toJulianDay())]->maxDay);
+    if (firstDay > lastDay) {
+        return result;
+    }
+    result.firstDay = firstDay;
+    result.dayCount = int(lastDay - firstDay + 1);
+    result.values.fill(0.0, result.categoryCount * result.dayCount);
+    const quint8 kind = static_cast<quint8>(type);
+    snapshot.forEachRowInRange(startDate, endDate, [&](const LedgerChunk& chunk, int row) {
+        int category = chunk.categories[row];
+        if (chunk.kinds[row] == kind && category >= 0) {
+            result.values[category * result.dayCount + int(chunk.days[row] - result.firstDay)] += chunk.amounts[row];
+        }
+    });
+    
+    return result;
+}
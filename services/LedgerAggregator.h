@@ -0,0 +1,60 @@
+#ifndef LEDGERAGGREGATOR_H
+#define LEDGERAGGREGATOR_H
+
+#include <QDate>
+#include <QVector>
+#include <functional>
+#include "../models/LedgerSnapshot.h"
+
+QT_BEGIN_NAMESPACE
+class QThreadPool;
+QT_END_NAMESPACE
+
+// 账本并行聚合：与日期范围相交的数据块由调用线程和线程池中的空闲线程
+// 通过原子计数器逐块领取（自调度），每个线程累计自己的局部结果，最后合并
+class LedgerAggregator {
+public:
+    struct Result {
+        qint64 firstDay = 0;               // 每日数组下标0对应的儒略日
+        QVector<double> dailyIncome;
+        QVector<double> dailyExpense;
+        QVector<double> categoryIncome;    // 按分类先序编号
+        QVector<double> categoryExpense;
+        double unknownIncome = 0.0;        // 未归入已知分类的金额
+        double unknownExpense = 0.0;
+        double totalIncome = 0.0;
+        double totalExpense = 0.0;
+        int transactionCount = 0;
+        
+        int dayCount() const { return dailyExpense.size(); }
+        QDate dateAt(int index) const { return QDate::fromJulianDay(firstDay + index); }
+        void merge(const Result& other);
+    };
+    
+    // 分类 × 日期的稠密金额矩阵，每个分类（按先序编号）一行
+    struct CategoryDaily {
+        qint64 firstDay = 0;
+        int dayCount = 0;
+        int categoryCount = 0;
+        QVector<double> values;            // [category * dayCount + day]
+        
+        // 分类区间 [firstCategory, endCategory)（如一个子树）的逐日前缀和，
+        // prefix[i] 为前 i 天的合计，任意日期区间的合计为两项之差
+        QVector<double> prefixSums(int firstCategory, int endCategory) const;
+    };
+    
+    // 数据块数量不超过该值时在调用线程内串行计算
+    static constexpr int kMinParallelChunks = 2;
+    
+    // maxWorkers <= 0 时按线程池容量决定；canceled 返回 true 时尽快结束并返回部分结果；起止日期无效时返回空结果
+    static Result aggregate(const LedgerSnapshot& snapshot, const QDate& startDate, const QDate& endDate,
+                            QThreadPool* pool = nullptr, int maxWorkers = 0,
+                            const std::function<bool()>& canceled = std::function<bool()>());
+    
+    // 一次遍历得到范围内某一收支类型按分类、按日的金额；未知分类的记录不计入。
+    // 日期范围收缩到快照中有数据的部分，调用方按 firstDay 和 dayCount 定位
+    static CategoryDaily categoryDaily(const LedgerSnapshot& snapshot, const QDate& startDate, const QDate& endDate,
+                                       Record::Type type);
+};
+
+#endif // LEDGERAGGREGATOR_H
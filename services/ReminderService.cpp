@@ -2,42 +2,59 @@
 #include <QDateTime>
 #include <QUuid>
 #include <QDebug>
+#include <algorithm>
+
+const QString ReminderService::kPeriodicReportId = "periodic-report";
 
 ReminderService::ReminderService(std::shared_ptr<User> user, QObject *parent)
     : QObject(parent)
     , m_user(user)
+    , m_running(false)
     , m_budgetAlertEnabled(true)
     , m_budgetAlertThreshold(0.8)
     , m_periodicReportEnabled(true)
-    , m_reportPeriodDays(30) {
+    , m_anomalyAlertEnabled(true)
+    , m_reportPeriodDays(30)
+    , m_firstSeq(0)
+    , m_nextSeq(0)
+    , m_unreadCount(0)
+    , m_subscriptionId(-1) {
     
-    // 创建定时器
-    m_periodicTimer = new QTimer(this);
-    m_reportTimer = new QTimer(this);
+    // 预算提醒由数据变更驱动；账单和定期报告共用一个单次定时器，只在最早到期项到期时唤醒
+    m_scheduleTimer = new QTimer(this);
+    m_scheduleTimer->setSingleShot(true);
+    connect(m_scheduleTimer, &QTimer::timeout, this, &ReminderService::onScheduleTimeout);
     
-    // 设置定时器间隔
-    m_periodicTimer->setInterval(60000); // 每分钟检查一次
-    m_reportTimer->setInterval(m_reportPeriodDays * 24 * 3600 * 1000); // 按设置周期
+    if (m_periodicReportEnabled) {
+        schedulePeriodicReport();
+    }
     
-    // 连接定时器信号
-    connect(m_periodicTimer, &QTimer::timeout, this, &ReminderService::onPeriodicCheck);
-    connect(m_reportTimer, &QTimer::timeout, this, &ReminderService::onPeriodicReport);
+    // 订阅数据变更
+    if (m_user) {
+        m_subscriptionId = m_user->subscribe([this](const User::ChangeEvent& event) {
+            onUserChanged(event);
+        });
+    }
 }
 
 ReminderService::~ReminderService() {
     stop();
+    if (m_user) {
+        m_user->unsubscribe(m_subscriptionId);
+    }
 }
 
 void ReminderService::start() {
-    m_periodicTimer->start();
-    if (m_periodicReportEnabled) {
-        m_reportTimer->start();
-    }
+    // 启动时补查一次已加载数据的预算状态
+    checkBudgetStatus();
+    m_running = true;
+    // 补发停机期间已到期的提醒并设置定时器
+    processDueReminders(QDateTime::currentDateTime());
 }
 
 void ReminderService::stop() {
-    m_periodicTimer->stop();
-    m_reportTimer->stop();
+    m_running = false;
+    m_scheduleTimer->stop();
 }
 
 void ReminderService::setBudgetAlertEnabled(bool enabled) {
@@ -47,23 +64,150 @@ void ReminderService::setBudgetAlertEnabled(bool enabled) {
 void ReminderService::setBudgetAlertThreshold(double threshold) {
     if (threshold >= 0.0 && threshold <= 1.0) {
         m_budgetAlertThreshold = threshold;
+        checkBudgetStatus();
     }
 }
 
 void ReminderService::setPeriodicReportEnabled(bool enabled) {
     m_periodicReportEnabled = enabled;
-    if (enabled) {
-        m_reportTimer->start();
-    } else {
-        m_reportTimer->stop();
+    if (!enabled) {
+        cancelScheduledReminder(kPeriodicReportId);
+    } else if (!m_scheduled.contains(kPeriodicReportId)) {
+        schedulePeriodicReport();
     }
 }
 
+void ReminderService::setAnomalyAlertEnabled(bool enabled) {
+    m_anomalyAlertEnabled = enabled;
+}
+
 void ReminderService::setReportPeriod(int days) {
     if (days > 0) {
         m_reportPeriodDays = days;
-        m_reportTimer->setInterval(days * 24 * 3600 * 1000);
+        if (m_scheduled.contains(kPeriodicReportId)) {
+            schedulePeriodicReport();
+        }
+    }
+}
+
+QString ReminderService::scheduleBillReminder(const QString& title, const QString& message,
+                                              const QDateTime& dueTime, int repeatMonths) {
+    if (!dueTime.isValid()) {
+        return QString();
+    }
+    
+    ScheduledReminder reminder;
+    reminder.id = generateReminderId();
+    reminder.type = ReminderType::BillReminder;
+    reminder.title = title;
+    reminder.message = message;
+    reminder.dueTime = dueTime;
+    reminder.firstDueTime = dueTime;
+    reminder.repeatMonths = std::max(0, repeatMonths);
+    addScheduled(reminder);
+    return reminder.id;
+}
+
+void ReminderService::cancelScheduledReminder(const QString& id) {
+    m_scheduled.remove(id);
+    if (m_schedule.cancel(id)) {
+        armScheduleTimer();
+    }
+}
+
+QVector<ReminderService::ScheduledReminder> ReminderService::getScheduledReminders() const {
+    QVector<ScheduledReminder> reminders;
+    reminders.reserve(m_scheduled.size());
+    for (auto it = m_scheduled.constBegin(); it != m_scheduled.constEnd(); ++it) {
+        reminders.append(it.value());
+    }
+    std::sort(reminders.begin(), reminders.end(), [](const ScheduledReminder& a, const ScheduledReminder& b) {
+        return a.dueTime < b.dueTime;
+    });
+    return reminders;
+}
+
+void ReminderService::restoreScheduledReminders(const QVector<ScheduledReminder>& reminders) {
+    m_scheduled.clear();
+    m_schedule.clear();
+    for (const auto& reminder : reminders) {
+        if (reminder.id.isEmpty() || !reminder.dueTime.isValid()) {
+            continue;
+        }
+        if (reminder.id == kPeriodicReportId && !m_periodicReportEnabled) {
+            continue;
+        }
+        m_scheduled.insert(reminder.id, reminder);
+        m_schedule.schedule(reminder.id, reminder.dueTime.toMSecsSinceEpoch());
+    }
+    
+    if (m_periodicReportEnabled && !m_scheduled.contains(kPeriodicReportId)) {
+        schedulePeriodicReport();
+    }
+    armScheduleTimer();
+}
+
+void ReminderService::processDueReminders(const QDateTime& now) {
+    const auto due = m_schedule.popDue(now.toMSecsSinceEpoch());
+    for (const auto& entry : due) {
+        if (!m_scheduled.contains(entry.id)) {
+            continue;
+        }
+        ScheduledReminder scheduled = m_scheduled.value(entry.id);
+        
+        // 先更新计划再发通知，通知的接收方可以安全地修改计划；
+        // 停机期间错过的多次重复只补发一次
+        if (scheduled.isRecurring()) {
+            ScheduledReminder next = scheduled;
+            if (!next.firstDueTime.isValid()) {
+                next.firstDueTime = next.dueTime;
+                next.occurrence = 0;
+            }
+            while (next.dueTime <= now) {
+                next.dueTime = next.occurrenceTime(++next.occurrence);
+            }
+            m_scheduled.insert(next.id, next);
+            m_schedule.schedule(next.id, next.dueTime.toMSecsSinceEpoch());
+        } else {
+            m_scheduled.remove(entry.id);
+        }
+        
+        sendNotification(createScheduledReminder(scheduled));
+    }
+    armScheduleTimer();
+}
+
+void ReminderService::addScheduled(const ScheduledReminder& reminder) {
+    m_scheduled.insert(reminder.id, reminder);
+    m_schedule.schedule(reminder.id, reminder.dueTime.toMSecsSinceEpoch());
+    armScheduleTimer();
+}
+
+void ReminderService::schedulePeriodicReport() {
+    ScheduledReminder reminder;
+    reminder.id = kPeriodicReportId;
+    reminder.type = ReminderType::PeriodicReport;
+    reminder.title = "定期报告";
+    reminder.dueTime = QDateTime::currentDateTime().addDays(m_reportPeriodDays);
+    reminder.firstDueTime = reminder.dueTime;
+    reminder.repeatDays = m_reportPeriodDays;
+    addScheduled(reminder);
+}
+
+void ReminderService::armScheduleTimer() {
+    if (!m_running || m_schedule.isEmpty()) {
+        m_scheduleTimer->stop();
+        return;
     }
+    
+    // 定时器间隔为 int 毫秒，较远的到期时间分段等待，醒来时没有到期项则重新设置
+    qint64 delay = m_schedule.next().deadline - QDateTime::currentDateTime().toMSecsSinceEpoch();
+    delay = std::max<qint64>(0, std::min(delay, kMaxTimerInterval));
+    m_scheduleTimer->start(int(delay));
+}
+
+void ReminderService::onScheduleTimeout() {
+    processDueReminders(QDateTime::currentDateTime());
 }
 
 void ReminderService::checkBudgetStatus() {
@@ -71,45 +215,156 @@ void ReminderService::checkBudgetStatus() {
         return;
     }
     
-    auto budgets = m_user->getAllBudgets();
+    // 提醒信号可能触发预算变更，遍历隐式共享的副本
+    const auto budgets = m_user->getAllBudgets();
     QDate currentDate = QDate::currentDate();
     
     for (const auto& budget : budgets) {
-        if (budget->getStartDate() <= currentDate && budget->getEndDate() >= currentDate) {
-            budget->checkAndUpdateStatus();
-            
-            // 检查是否需要发送提醒
-            if (shouldSendBudgetWarning(budget)) {
-                auto category = m_user->getCategory(budget->getCategoryId());
-                QString categoryName = category ? category->getName() : "未知分类";
-                
-                emit budgetWarning(categoryName, budget->getUsagePercentage());
-                
-                Reminder reminder = createBudgetWarningReminder(categoryName, budget->getUsagePercentage());
-                sendNotification(reminder);
-                
-            } else if (shouldSendBudgetOver(budget)) {
-                auto category = m_user->getCategory(budget->getCategoryId());
-                QString categoryName = category ? category->getName() : "未知分类";
-                double overAmount = budget->getUsedAmount() - budget->getTotalAmount();
-                
-                emit budgetOver(categoryName, overAmount);
-                
-                Reminder reminder = createBudgetOverReminder(categoryName, overAmount);
-                sendNotification(reminder);
-            }
+        checkBudget(budget, currentDate);
+    }
+}
+
+void ReminderService::setReportService(std::shared_ptr<ReportService> reportService) {
+    if (m_reportService) {
+        disconnect(m_reportService.get(), &ReportService::budgetForecastChanged,
+                   this, &ReminderService::checkBudgetForecast);
+    }
+    m_reportService = reportService;
+    if (m_reportService) {
+        connect(m_reportService.get(), &ReportService::budgetForecastChanged,
+                this, &ReminderService::checkBudgetForecast);
+    }
+}
+
+void ReminderService::checkBudgetForecast(const ReportService::BudgetForecast& forecast) {
+    if (!m_budgetAlertEnabled || !forecast.willExceed() || forecast.spent > forecast.budgeted) {
+        return;
+    }
+    
+    // 每个预算只记住最近提醒过的周期，进入新周期时自然覆盖
+    auto warned = m_forecastWarnings.constFind(forecast.budgetId);
+    if (warned != m_forecastWarnings.constEnd() && warned.value() == forecast.startDate) {
+        return;
+    }
+    m_forecastWarnings.insert(forecast.budgetId, forecast.startDate);
+    
+    auto category = m_user->getCategory(forecast.categoryId);
+    QString categoryName = category ? category->getName() : "未知分类";
+    emit budgetForecastOver(categoryName, forecast.projected, forecast.budgeted);
+    sendNotification(createBudgetForecastReminder(categoryName, forecast.projected, forecast.budgeted));
+}
+
+void ReminderService::onUserChanged(const User::ChangeEvent& event) {
+    if (m_anomalyAlertEnabled && !event.anomalies.isEmpty()) {
+        notifyAnomalies(event.anomalies);
+    }
+    if (event.kind == User::ChangeEvent::Kind::BudgetRemoved) {
+        m_budgetAlerts.remove(event.budget->getId());
+        m_forecastWarnings.remove(event.budget->getId());
+        return;
+    }
+    if (!m_budgetAlertEnabled) {
+        return;
+    }
+    
+    QDate currentDate = QDate::currentDate();
+    if (event.isRecordEvent()) {
+        for (const auto& budget : event.affectedBudgets) {
+            checkBudget(budget, currentDate);
         }
+    } else if (event.budget) {
+        // 新增或修改的预算：金额、阈值或周期可能变化
+        checkBudget(event.budget, currentDate);
     }
 }
 
+void ReminderService::notifyAnomalies(const QVector<User::Anomaly>& anomalies) {
+    auto categoryNameOf = [this](const Record& record) {
+        auto category = m_user->getCategory(record.getCategoryId());
+        return category ? category->getName() : QString("未知分类");
+    };
+    
+    if (anomalies.size() <= kMaxAnomalyReminders) {
+        for (const auto& anomaly : anomalies) {
+            QString categoryName = categoryNameOf(*anomaly.record);
+            emit amountAnomaly(categoryName, anomaly.record->getAmount(), anomaly.typicalAmount);
+            sendNotification(createAnomalyReminder(categoryName, anomaly.record->getAmount(), anomaly.typicalAmount));
+        }
+        return;
+    }
+    
+    // 批量导入时只提示分数最高的一笔和异常笔数
+    auto strongest = std::max_element(anomalies.cbegin(), anomalies.cend(),
+                                      [](const User::Anomaly& a, const User::Anomaly& b) {
+        return a.score < b.score;
+    });
+    QString categoryName = categoryNameOf(*strongest->record);
+    emit amountAnomaly(categoryName, strongest->record->getAmount(), strongest->typicalAmount);
+    Reminder reminder = createAnomalyReminder(categoryName, strongest->record->getAmount(), strongest->typicalAmount);
+    reminder.message = QString("本次新增的记录中有 %1 笔金额异常，其中 %2")
+                           .arg(anomalies.size())
+                           .arg(reminder.message);
+    sendNotification(reminder);
+}
+
+void ReminderService::checkBudget(std::shared_ptr<Budget> budget, const QDate& currentDate) {
+    if (budget->getStartDate() > currentDate || budget->getEndDate() < currentDate) {
+        return;
+    }
+    budget->checkAndUpdateStatus();
+    
+    // 进入新周期时重新计算已提醒级别；已用金额回落不降低级别，避免在阈值附近反复提醒
+    BudgetAlertState& state = m_budgetAlerts[budget->getId()];
+    if (state.startDate != budget->getStartDate()) {
+        state.startDate = budget->getStartDate();
+        state.level = AlertLevel::None;
+    }
+    AlertLevel level = alertLevel(*budget);
+    if (level <= state.level) {
+        return;
+    }
+    state.level = level;
+    
+    auto category = m_user->getCategory(budget->getCategoryId());
+    QString categoryName = category ? category->getName() : "未知分类";
+    if (level == AlertLevel::Warning) {
+        emit budgetWarning(categoryName, budget->getUsagePercentage());
+        sendNotification(createBudgetWarningReminder(categoryName, budget->getUsagePercentage()));
+    } else {
+        double overAmount = budget->getUsedAmount() - budget->getTotalAmount();
+        emit budgetOver(categoryName, overAmount);
+        sendNotification(createBudgetOverReminder(categoryName, overAmount));
+    }
+}
+
+ReminderService::AlertLevel ReminderService::alertLevel(const Budget& budget) const {
+    if (budget.isOverBudget()) {
+        return AlertLevel::Over;
+    }
+    if (budget.isInWarning() && budget.getUsagePercentage() >= m_budgetAlertThreshold) {
+        return AlertLevel::Warning;
+    }
+    return AlertLevel::None;
+}
+
 QVector<ReminderService::Reminder> ReminderService::getAllReminders() const {
-    return m_reminders;
+    QVector<Reminder> reminders;
+    reminders.reserve(m_reminderIndex.size());
+    for (qint64 seq = m_firstSeq; seq < m_nextSeq; ++seq) {
+        const Reminder& reminder = reminderAt(seq);
+        if (!reminder.id.isEmpty()) {
+            reminders.append(reminder);
+        }
+    }
+    return reminders;
 }
 
 QVector<ReminderService::Reminder> ReminderService::getUnreadReminders() const {
     QVector<Reminder> unreadReminders;
-    for (const auto& reminder : m_reminders) {
-        if (!reminder.isRead) {
+    unreadReminders.reserve(m_unreadCount);
+    for (qint64 seq = m_firstSeq; seq < m_nextSeq; ++seq) {
+        const Reminder& reminder = reminderAt(seq);
+        if (!reminder.id.isEmpty() && !reminder.isRead) {
             unreadReminders.append(reminder);
         }
     }
@@ -117,49 +372,54 @@ QVector<ReminderService::Reminder> ReminderService::getUnreadReminders() const {
 }
 
 void ReminderService::markReminderAsRead(const QString& reminderId) {
-    for (auto& reminder : m_reminders) {
-        if (reminder.id == reminderId) {
-            reminder.isRead = true;
-            break;
-        }
+    auto it = m_reminderIndex.constFind(reminderId);
+    if (it == m_reminderIndex.constEnd()) {
+        return;
+    }
+    Reminder& reminder = reminderAt(it.value());
+    if (!reminder.isRead) {
+        reminder.isRead = true;
+        --m_unreadCount;
+        emit unreadCountChanged(m_unreadCount);
     }
-    emit unreadCountChanged(getUnreadReminders().size());
 }
 
 void ReminderService::markAllRemindersAsRead() {
-    for (auto& reminder : m_reminders) {
-        reminder.isRead = true;
+    for (qint64 seq = m_firstSeq; seq < m_nextSeq; ++seq) {
+        reminderAt(seq).isRead = true;
     }
+    m_unreadCount = 0;
     emit unreadCountChanged(0);
 }
 
 void ReminderService::clearReminder(const QString& reminderId) {
-    m_reminders.erase(
-        std::remove_if(m_reminders.begin(), m_reminders.end(),
-            [&reminderId](const Reminder& reminder) {
-                return reminder.id == reminderId;
-            }),
-        m_reminders.end()
-    );
-    emit unreadCountChanged(getUnreadReminders().size());
+    auto it = m_reminderIndex.constFind(reminderId);
+    if (it == m_reminderIndex.constEnd()) {
+        return;
+    }
+    Reminder& reminder = reminderAt(it.value());
+    if (!reminder.isRead) {
+        --m_unreadCount;
+    }
+    reminder = Reminder();
+    m_reminderIndex.remove(reminderId);
+    
+    // 回收缓冲头部的空槽
+    while (m_firstSeq < m_nextSeq && reminderAt(m_firstSeq).id.isEmpty()) {
+        ++m_firstSeq;
+    }
+    emit unreadCountChanged(m_unreadCount);
 }
 
 void ReminderService::clearAllReminders() {
     m_reminders.clear();
+    m_reminderIndex.clear();
+    m_firstSeq = 0;
+    m_nextSeq = 0;
+    m_unreadCount = 0;
     emit unreadCountChanged(0);
 }
 
-void ReminderService::onPeriodicCheck() {
-    checkBudgetStatus();
-}
-
-void ReminderService::onPeriodicReport() {
-    if (m_periodicReportEnabled) {
-        Reminder reminder = createPeriodicReportReminder();
-        sendNotification(reminder);
-    }
-}
-
 QString ReminderService::generateReminderId() {
     return QUuid::createUuid().toString();
 }
@@ -188,6 +448,38 @@ ReminderService::Reminder ReminderService::createBudgetOverReminder(const QStrin
     return reminder;
 }
 
+ReminderService::Reminder ReminderService::createAnomalyReminder(const QString& categoryName,
+                                                                double amount, double typicalAmount) {
+    Reminder reminder;
+    reminder.id = generateReminderId();
+    reminder.type = ReminderType::AmountAnomaly;
+    reminder.title = "金额异常";
+    reminder.message = QString("%1 的一笔交易金额为 ¥%2，明显高于该分类通常的 ¥%3，请确认是否有误。")
+                           .arg(categoryName)
+                           .arg(amount, 0, 'f', 2)
+                           .arg(typicalAmount, 0, 'f', 2);
+    reminder.timestamp = QDateTime::currentDateTime();
+    reminder.isRead = false;
+    
+    return reminder;
+}
+
+ReminderService::Reminder ReminderService::createBudgetForecastReminder(const QString& categoryName,
+                                                                       double projectedAmount, double budgetAmount) {
+    Reminder reminder;
+    reminder.id = generateReminderId();
+    reminder.type = ReminderType::BudgetForecastOver;
+    reminder.title = "预计超支";
+    reminder.message = QString("按近期支出趋势，%1 本周期预计支出 ¥%2，将超出预算 ¥%3。")
+                           .arg(categoryName)
+                           .arg(projectedAmount, 0, 'f', 2)
+                           .arg(budgetAmount, 0, 'f', 2);
+    reminder.timestamp = QDateTime::currentDateTime();
+    reminder.isRead = false;
+    
+    return reminder;
+}
+
 ReminderService::Reminder ReminderService::createPeriodicReportReminder() {
     Reminder reminder;
     reminder.id = generateReminderId();
@@ -200,17 +492,54 @@ ReminderService::Reminder ReminderService::createPeriodicReportReminder() {
     return reminder;
 }
 
-void ReminderService::sendNotification(const Reminder& reminder) {
-    m_reminders.append(reminder);
-    emit reminderTriggered(reminder);
-    emit unreadCountChanged(getUnreadReminders().size());
+ReminderService::Reminder ReminderService::createScheduledReminder(const ScheduledReminder& scheduled) {
+    if (scheduled.type == ReminderType::PeriodicReport) {
+        return createPeriodicReportReminder();
+    }
+    
+    Reminder reminder;
+    reminder.id = generateReminderId();
+    reminder.type = scheduled.type;
+    reminder.title = scheduled.title;
+    reminder.message = scheduled.message;
+    reminder.timestamp = QDateTime::currentDateTime();
+    reminder.isRead = false;
+    reminder.data = scheduled.id;
+    
+    return reminder;
 }
 
-bool ReminderService::shouldSendBudgetWarning(std::shared_ptr<Budget> budget) {
-    return budget->getStatus() == Budget::Status::Warning && 
-           budget->getUsagePercentage() >= m_budgetAlertThreshold;
+void ReminderService::sendNotification(const Reminder& reminder) {
+    appendReminder(reminder);
+    emit reminderTriggered(reminder);
+    emit unreadCountChanged(m_unreadCount);
 }
 
-bool ReminderService::shouldSendBudgetOver(std::shared_ptr<Budget> budget) {
-    return budget->getStatus() == Budget::Status::OverBudget;
+void ReminderService::appendReminder(const Reminder& reminder) {
+    // 缓冲已满时移出最早的一条（空槽直接丢弃）
+    if (m_nextSeq - m_firstSeq == kMaxReminders) {
+        Reminder oldest = reminderAt(m_firstSeq);
+        ++m_firstSeq;
+        if (!oldest.id.isEmpty()) {
+            m_reminderIndex.remove(oldest.id);
+            if (!oldest.isRead) {
+                --m_unreadCount;
+            }
+            emit reminderArchived(oldest);
+        }
+        while (m_firstSeq < m_nextSeq && reminderAt(m_firstSeq).id.isEmpty()) {
+            ++m_firstSeq;
+        }
+    }
+    
+    if (m_reminders.size() < kMaxReminders) {
+        m_reminders.append(reminder);
+    } else {
+        reminderAt(m_nextSeq) = reminder;
+    }
+    m_reminderIndex.insert(reminder.id, m_nextSeq);
+    ++m_nextSeq;
+    if (!reminder.isRead) {
+        ++m_unreadCount;
+    }
 }
\ No newline at end of file
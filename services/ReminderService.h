@@ -3,9 +3,12 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QHash>
 #include <memory>
 #include "../models/User.h"
 #include "../models/Budget.h"
+#include "../models/DeadlineQueue.h"
+#include "ReportService.h"
 
 class ReminderService : public QObject {
     Q_OBJECT
@@ -15,7 +18,9 @@ public:
         BudgetWarning,
         BudgetOver,
         PeriodicReport,
-        BillReminder
+        BillReminder,
+        BudgetForecastOver,
+        AmountAnomaly
     };
     
     struct Reminder {
@@ -28,6 +33,28 @@ public:
         QVariant data;
     };
     
+    // 定时提醒（账单到期、定期报告），repeatDays/repeatMonths 均为 0 时只提醒一次
+    struct ScheduledReminder {
+        QString id;
+        ReminderType type = ReminderType::BillReminder;
+        QString title;
+        QString message;
+        QDateTime dueTime;          // 下一次到期时间
+        QDateTime firstDueTime;     // 重复项从首次到期时间推算，避免月末日期逐月漂移
+        int occurrence = 0;         // dueTime 是第几次重复
+        int repeatDays = 0;
+        int repeatMonths = 0;
+        
+        bool isRecurring() const { return repeatDays > 0 || repeatMonths > 0; }
+        QDateTime occurrenceTime(int n) const {
+            return firstDueTime.addMonths(n * repeatMonths).addDays(qint64(n) * repeatDays);
+        }
+    };
+    
+    static const QString kPeriodicReportId;
+    // 内存中保留的提醒条数，超出时最早的提醒移出并通过 reminderArchived 交给存储归档
+    static constexpr int kMaxReminders = 500;
+    
     explicit ReminderService(std::shared_ptr<User> user, QObject *parent = nullptr);
     ~ReminderService();
     
@@ -40,13 +67,29 @@ public:
     void setBudgetAlertThreshold(double threshold); // 0.0 - 1.0
     void setPeriodicReportEnabled(bool enabled);
     void setReportPeriod(int days);
+    void setAnomalyAlertEnabled(bool enabled);
+    
+    // 定时提醒：只在最早的一项到期时唤醒，数量多时也不需要轮询
+    QString scheduleBillReminder(const QString& title, const QString& message,
+                                 const QDateTime& dueTime, int repeatMonths = 0);
+    void cancelScheduledReminder(const QString& id);
+    QVector<ScheduledReminder> getScheduledReminders() const;
+    // 恢复保存的定时提醒（替换当前计划），停机期间已到期的项在下次处理时补发
+    void restoreScheduledReminders(const QVector<ScheduledReminder>& reminders);
+    // 发送所有不晚于 now 到期的提醒，重复项顺延到 now 之后的下一次
+    void processDueReminders(const QDateTime& now);
     
-    // 检查预算状态
+    // 全量检查预算状态（启动或阈值变化时），平时由数据变更驱动
     void checkBudgetStatus();
     
+    // 接收报告服务的预算预测：预计周期末超支而尚未超支时提前提醒，每个预算周期只提醒一次
+    void setReportService(std::shared_ptr<ReportService> reportService);
+    void checkBudgetForecast(const ReportService::BudgetForecast& forecast);
+    
     // 获取提醒列表
     QVector<Reminder> getAllReminders() const;
     QVector<Reminder> getUnreadReminders() const;
+    int getUnreadCount() const { return m_unreadCount; }
     
     // 标记提醒已读
     void markReminderAsRead(const QString& reminderId);
@@ -60,23 +103,64 @@ signals:
     void reminderTriggered(const Reminder& reminder);
     void budgetWarning(const QString& categoryName, double usedPercent);
     void budgetOver(const QString& categoryName, double overAmount);
+    void budgetForecastOver(const QString& categoryName, double projectedAmount, double budgetAmount);
+    void amountAnomaly(const QString& categoryName, double amount, double typicalAmount);
     void unreadCountChanged(int count);
+    void reminderArchived(const Reminder& reminder);
 
 private slots:
-    void onPeriodicCheck();
-    void onPeriodicReport();
+    void onScheduleTimeout();
 
 private:
     std::shared_ptr<User> m_user;
-    QTimer* m_periodicTimer;
-    QTimer* m_reportTimer;
+    std::shared_ptr<ReportService> m_reportService;
+    QTimer* m_scheduleTimer;
+    bool m_running;
     
     bool m_budgetAlertEnabled;
     double m_budgetAlertThreshold;
     bool m_periodicReportEnabled;
+    bool m_anomalyAlertEnabled;
     int m_reportPeriodDays;
     
+    // 提醒按序号存放在环形缓冲中，序号 seq 位于槽位 seq % kMaxReminders；
+    // 清除的提醒留下 id 为空的空槽，随最早的提醒一起回收
     QVector<Reminder> m_reminders;
+    qint64 m_firstSeq;
+    qint64 m_nextSeq;
+    QHash<QString, qint64> m_reminderIndex;  // 提醒ID -> 序号
+    int m_unreadCount;
+    QHash<QString, ScheduledReminder> m_scheduled;
+    DeadlineQueue m_schedule;
+    int m_subscriptionId;
+    QHash<QString, QDate> m_forecastWarnings;   // 预算ID -> 已提醒过预计超支的周期开始日期
+    
+    // 每个预算在当前周期内已提醒过的最高级别，只在越过更高阈值时提醒
+    enum class AlertLevel {
+        None,
+        Warning,
+        Over
+    };
+    struct BudgetAlertState {
+        QDate startDate;
+        AlertLevel level = AlertLevel::None;
+    };
+    QHash<QString, BudgetAlertState> m_budgetAlerts;
+    
+    // 数据变更时只检查已用金额发生变化的预算
+    void onUserChanged(const User::ChangeEvent& event);
+    void checkBudget(std::shared_ptr<Budget> budget, const QDate& currentDate);
+    AlertLevel alertLevel(const Budget& budget) const;
+    // 新增记录的异常金额：少量时逐笔提醒，批量导入时合并为一条
+    void notifyAnomalies(const QVector<User::Anomaly>& anomalies);
+    static constexpr int kMaxAnomalyReminders = 3;
+    
+    // 定时提醒
+    void addScheduled(const ScheduledReminder& reminder);
+    void schedulePeriodicReport();
+    // 按最早到期时间重设单次定时器，间隔超过定时器上限时分段等待
+    void armScheduleTimer();
+    static constexpr qint64 kMaxTimerInterval = 24LL * 3600 * 1000;
     
     // 生成提醒ID
     QString generateReminderId();
@@ -84,14 +168,16 @@ private:
     // 创建提醒
     Reminder createBudgetWarningReminder(const QString& categoryName, double usedPercent);
     Reminder createBudgetOverReminder(const QString& categoryName, double overAmount);
+    Reminder createAnomalyReminder(const QString& categoryName, double amount, double typicalAmount);
+    Reminder createBudgetForecastReminder(const QString& categoryName, double projectedAmount, double budgetAmount);
     Reminder createPeriodicReportReminder();
+    Reminder createScheduledReminder(const ScheduledReminder& scheduled);
     
     // 发送通知
     void sendNotification(const Reminder& reminder);
-    
-    // 检查是否需要发送提醒
-    bool shouldSendBudgetWarning(std::shared_ptr<Budget> budget);
-    bool shouldSendBudgetOver(std::shared_ptr<Budget> budget);
+    void appendReminder(const Reminder& reminder);
+    Reminder& reminderAt(qint64 seq) { return m_reminders[int(seq % kMaxReminders)]; }
+    const Reminder& reminderAt(qint64 seq) const { return m_reminders[int(seq % kMaxReminders)]; }
 };
 
 #endif // REMINDERSERVICE_H
\ No newline at end of file
@@ -1,167 +1,1261 @@
 #include "ReportService.h"
 #include <QDate>
 #include <QDebug>
+#include <QHash>
+#include <QPromise>
+#include <algorithm>
+#include "../models/StringPool.h"
+#include "../models/SpaceSaving.h"
+#include "LedgerAggregator.h"
+
+namespace {
+
+// 按分类先序编号的合计转换为以显示路径为键的结果
+QMap<QString, double> labelCategoryTotals(const CategoryHierarchy& hierarchy,
+                                          const QVector<double>& totals, double unknownTotal) {
+    QMap<QString, double> result;
+    for (int i = 0; i < totals.size(); ++i) {
+        if (totals[i] != 0.0) {
+            result[hierarchy.displayPathAt(i)] = totals[i];
+        }
+    }
+    if (unknownTotal != 0.0) {
+        result["未知分类"] += unknownTotal;
+    }
+    return result;
+}
+
+// 备注到去向键的缓存上限，与范围内不同备注的数量无关
+const int kNoteKeyCacheSize = 4096;
+
+// 规范化备注的 64 位 FNV-1a 哈希，0 留给空备注
+quint64 noteKey(const QString& normalized) {
+    if (normalized.isEmpty()) {
+        return 0;
+    }
+    quint64 hash = 14695981039346656037ull;
+    for (QChar ch : normalized) {
+        hash ^= ch.unicode();
+        hash *= 1099511628211ull;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+// 精确分组时每个去向的合计及首次出现的备注编号
+struct DestinationTotal {
+    int noteId = 0;
+    double amount = 0.0;
+};
+
+ReportService::AmountQuantiles sketchQuantiles(const QuantileSketch& sketch) {
+    ReportService::AmountQuantiles quantiles;
+    quantiles.count = sketch.count();
+    quantiles.median = sketch.quantile(0.5);
+    quantiles.p90 = sketch.quantile(0.9);
+    quantiles.p99 = sketch.quantile(0.99);
+    return quantiles;
+}
+
+ReportService::ChartData categoryChartData(const QMap<QString, double>& categoryData,
+                                           ReportService::TimeDimension dimension) {
+    ReportService::ChartData chartData;
+    chartData.type = ReportService::ReportType::CategoryAnalysis;
+    chartData.dimension = dimension;
+    chartData.title = "分类统计";
+    chartData.unit = "元";
+    for (auto it = categoryData.begin(); it != categoryData.end(); ++it) {
+        chartData.values.append(it.value());
+        chartData.labels.append(it.key());
+    }
+    return chartData;
+}
+
+template <typename T>
+QFuture<T> readyFuture(T value) {
+    QPromise<T> promise;
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(std::move(value));
+    promise.finish();
+    return future;
+}
+
+} // namespace
 
 ReportService::ReportService(std::shared_ptr<User> user, QObject *parent)
     : QObject(parent)
-    , m_user(user) {
+    , m_user(user)
+    , m_subscriptionId(-1)
+    , m_cacheVersion(0) {
+    m_statisticsCache.setMaxCost(kCacheCapacity);
+    m_chartCache.setMaxCost(kCacheCapacity);
+    
+    // 只发出最新一次请求的结果，被取消的请求静默丢弃
+    connect(&m_statisticsWatcher, &QFutureWatcher<StatisticsData>::finished, this, [this]() {
+        if (!m_statisticsWatcher.isCanceled() && m_statisticsWatcher.future().resultCount() > 0) {
+            StatisticsData data = m_statisticsWatcher.result();
+            storeInCache(m_statisticsCache, m_pendingStatistics, data);
+            emit reportGenerated(data);
+        }
+    });
+    connect(&m_chartWatcher, &QFutureWatcher<ChartData>::finished, this, [this]() {
+        if (!m_chartWatcher.isCanceled() && m_chartWatcher.future().resultCount() > 0) {
+            ChartData chartData = m_chartWatcher.result();
+            storeInCache(m_chartCache, m_pendingChart, chartData);
+            emit chartDataReady(chartData);
+        }
+    });
+    
+    if (m_user) {
+        rebuildCube();
+        m_subscriptionId = m_user->subscribe([this](const User::ChangeEvent& event) {
+            onUserChanged(event);
+        });
+    }
 }
 
-ReportService::StatisticsData ReportService::generateStatistics(const QDate& startDate, const QDate& endDate) {
-    StatisticsData data;
+ReportService::~ReportService() {
+    cancelPendingReports();
+    m_pool.waitForDone();
+    if (m_user) {
+        m_user->unsubscribe(m_subscriptionId);
+    }
+}
+
+void ReportService::onUserChanged(const User::ChangeEvent& event) {
+    using Kind = User::ChangeEvent::Kind;
+    switch (event.kind) {
+        case Kind::RecordsAdded:
+            for (const auto& record : event.records) {
+                applyToCube(*record, 1);
+            }
+            break;
+        case Kind::RecordsRemoved:
+            for (const auto& record : event.records) {
+                applyToCube(*record, -1);
+            }
+            break;
+        case Kind::RecordModified:
+            if (event.before) {
+                applyToCube(*event.before, -1);
+            }
+            for (const auto& record : event.records) {
+                applyToCube(*record, 1);
+            }
+            break;
+        case Kind::CategoryAdded:
+        case Kind::CategoryModified:
+        case Kind::CategoryRemoved:
+            // 分类结构变化会改变先序编号
+            rebuildCube();
+            break;
+        default:
+            break;
+    }
+    refreshStaleSketches();
+    updateForecasts(event);
+}
+
+void ReportService::updateForecasts(const User::ChangeEvent& event) {
+    using Kind = User::ChangeEvent::Kind;
+    switch (event.kind) {
+        case Kind::RecordsAdded:
+        case Kind::RecordModified:
+        case Kind::RecordsRemoved: {
+            // 只有按日期顺序新增的支出可以增量加入；修改、删除或补录更早的记录时重新拟合相关预算
+            const auto& hierarchy = m_user->getCategoryHierarchy();
+            const QDate today = QDate::currentDate();
+            QVector<std::shared_ptr<const Record>> records(event.records.cbegin(), event.records.cend());
+            if (event.before) {
+                records.append(event.before);
+            }
+            for (const auto& record : records) {
+                if (record->getType() != Record::Type::Expense) {
+                    continue;
+                }
+                int category = hierarchy.indexOf(record->getCategoryId());
+                // 未来日期的记录按今天计入，模型的当前日不越过今天，之间的日子仍会被预测
+                QDate day = std::min(record->getDate(), today);
+                for (auto it = m_forecasts.begin(); it != m_forecasts.end();) {
+                    ForecastState& state = it.value();
+                    bool covered = category >= state.firstCategory && category < state.endCategory;
+                    if (covered && (event.kind != Kind::RecordsAdded
+                                    || !state.model.add(day, record->getAmount()))) {
+                        it = m_forecasts.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+        
+            for (const auto& budget : event.affectedBudgets) {
+                if (User::budgetCoversDay(*budget, today.toJulianDay())) {
+                    emit budgetForecastChanged(getBudgetForecast(budget, today));
+                }
+            }
+            break;
+        }
+        case Kind::CategoryAdded:
+        case Kind::CategoryModified:
+        case Kind::CategoryRemoved:
+            m_forecasts.clear();
+            break;
+        case Kind::BudgetAdded:
+        case Kind::BudgetModified:
+        case Kind::BudgetRemoved:
+            if (event.budget) {
+                m_forecasts.remove(event.budget->getId());
+            }
+            break;
+    }
+}
+
+ReportService::ForecastState& ReportService::forecastState(const Budget& budget, const QDate& date) {
+    auto it = m_forecasts.find(budget.getId());
+    if (it != m_forecasts.end()) {
+        return it.value();
+    }
     
-    // 获取基础统计数据
-    data.totalIncome = m_user->getTotalIncome(startDate, endDate);
-    data.totalExpense = m_user->getTotalExpense(startDate, endDate);
-    data.balance = data.totalIncome - data.totalExpense;
-    data.avgDailyExpense = calculateAverageDailyExpense(startDate, endDate);
+    // 从历史范围内第一笔支出开始逐日加入，之前没有数据的日子不参与拟合
+    ForecastState state;
+    auto snapshot = m_user->snapshot();
+    const auto& hierarchy = snapshot->hierarchy();
+    state.firstCategory = hierarchy.indexOf(budget.getCategoryId());
+    if (state.firstCategory >= 0) {
+        state.endCategory = hierarchy.subtreeEnd(state.firstCategory);
+        // 与增量更新一致，周期内未来日期的支出按 date 当天计入
+        QDate from = date.addDays(1 - kForecastHistoryDays);
+        QDate to = budget.getEndDate() > date ? budget.getEndDate() : date;
+        auto daily = LedgerAggregator::categoryDaily(*snapshot, from, to, Record::Type::Expense);
+        QVector<double> prefix = daily.prefixSums(state.firstCategory, state.endCategory);
+        for (int day = 0; day < daily.dayCount; ++day) {
+            double amount = prefix[day + 1] - prefix[day];
+            if (state.model.isValid() || amount != 0.0) {
+                state.model.add(std::min(QDate::fromJulianDay(daily.firstDay + day), date), amount);
+            }
+        }
+    }
+    return m_forecasts.insert(budget.getId(), state).value();
+}
+
+QVector<ReportService::BudgetForecast> ReportService::getBudgetForecasts(const QDate& date) {
+    QVector<BudgetForecast> forecasts;
+    for (const auto& budget : m_user->getAllBudgets()) {
+        if (User::budgetCoversDay(*budget, date.toJulianDay())) {
+            forecasts.append(getBudgetForecast(budget, date));
+        }
+    }
+    return forecasts;
+}
+
+ReportService::BudgetForecast ReportService::getBudgetForecast(const std::shared_ptr<Budget>& budget,
+                                                               const QDate& date) {
+    BudgetForecast forecast;
+    forecast.budgetId = budget->getId();
+    forecast.categoryId = budget->getCategoryId();
+    forecast.startDate = budget->getStartDate();
+    forecast.endDate = budget->getEndDate();
+    forecast.budgeted = budget->getTotalAmount();
+    forecast.spent = budget->getUsedAmount();
+    forecast.projected = forecast.spent;
+    if (!User::budgetCoversDay(*budget, date.toJulianDay())) {
+        return forecast;
+    }
+    
+    // 在副本上前进到 date，增量状态保持不变；已用金额由 User 增量维护，只预测之后的日子
+    SpendingForecast model = forecastState(*budget, date).model;
+    if (!model.isValid()) {
+        return forecast;
+    }
+    model.advanceTo(date);
+    QDate from = std::max(date, model.currentDay()).addDays(1);
+    forecast.projected += model.projectRange(from, forecast.endDate);
+    return forecast;
+}
+
+void ReportService::rebuildCube() {
+    auto snapshot = m_user->snapshot();
+    m_cube = CategoryMonthCube(snapshot->hierarchy().size());
+    m_amountSketches.clear();
+    m_staleSketches.clear();
+    for (const auto& chunk : snapshot->chunks()) {
+        // 同一天的行连续出现，只在日期变化时换算月份
+        qint64 day = 0;
+        int month = 0;
+        for (int row = 0; row < chunk->size(); ++row) {
+            if (row == 0 || chunk->days[row] != day) {
+                day = chunk->days[row];
+                month = CategoryMonthCube::monthOf(QDate::fromJulianDay(day));
+            }
+            auto type = static_cast<Record::Type>(chunk->kinds[row]);
+            m_cube.add(type, chunk->categories[row], month, chunk->amounts[row], 1);
+            m_amountSketches[sketchKey(type, chunk->categories[row], month)].insert(chunk->amounts[row]);
+        }
+    }
+}
+
+void ReportService::applyToCube(const Record& record, int sign) {
+    int category = m_user->getCategoryHierarchy().indexOf(record.getCategoryId());
+    int month = CategoryMonthCube::monthOf(record.getDate());
+    m_cube.add(record.getType(), category, month, sign * record.getAmount(), sign);
+    
+    qint64 key = sketchKey(record.getType(), category, month);
+    if (sign > 0) {
+        m_amountSketches[key].insert(record.getAmount());
+    } else {
+        m_staleSketches.insert(key);
+    }
+}
+
+qint64 ReportService::sketchKey(Record::Type type, int category, int month) const {
+    // 与立方体一致，超出范围的分类编号归入未知分类
+    const int rows = m_cube.unknownCategory() + 1;
+    if (category < 0 || category >= m_cube.unknownCategory()) {
+        category = m_cube.unknownCategory();
+    }
+    int typeIndex = type == Record::Type::Income ? 1 : 0;
+    return (qint64(month) * 2 + typeIndex) * rows + category;
+}
+
+void ReportService::refreshStaleSketches() {
+    if (m_staleSketches.isEmpty()) {
+        return;
+    }
+    
+    // 快照在通知监听者之前已更新，按月重新扫描即得到撤销后的数据
+    auto snapshot = m_user->snapshot();
+    const int rows = m_cube.unknownCategory() + 1;
+    for (qint64 key : m_staleSketches) {
+        int category = int(key % rows);
+        int typeIndex = int((key / rows) % 2);
+        int month = int(key / rows / 2);
+        const quint8 kind = static_cast<quint8>(typeIndex == 1 ? Record::Type::Income : Record::Type::Expense);
+    
+        QuantileSketch sketch;
+        QDate monthStart = CategoryMonthCube::monthStart(month);
+        snapshot->forEachRowInRange(monthStart, monthStart.addMonths(1).addDays(-1),
+                                    [&](const LedgerChunk& chunk, int row) {
+            if (chunk.kinds[row] == kind
+                && sketchKey(static_cast<Record::Type>(kind), chunk.categories[row], month) == key) {
+                sketch.insert(chunk.amounts[row]);
+            }
+        });
+        if (sketch.isEmpty()) {
+            m_amountSketches.remove(key);
+        } else {
+            m_amountSketches.insert(key, sketch);
+        }
+    }
+    m_staleSketches.clear();
+}
+
+ReportService::MonthSplit ReportService::splitByMonth(const LedgerSnapshot& snapshot,
+                                                      const QDate& startDate, const QDate& endDate) {
+    // 首尾月份在范围外没有记录时按整月处理，否则只扫描范围内的那一段
+    MonthSplit split;
+    split.firstMonth = CategoryMonthCube::monthOf(startDate);
+    split.lastMonth = CategoryMonthCube::monthOf(endDate);
+    QDate firstMonthStart = CategoryMonthCube::monthStart(split.firstMonth);
+    QDate lastMonthEnd = CategoryMonthCube::monthStart(split.lastMonth + 1).addDays(-1);
+    bool firstWhole = startDate == firstMonthStart
+        || snapshot.countInRange(firstMonthStart, startDate.addDays(-1)) == 0;
+    bool lastWhole = endDate == lastMonthEnd
+        || snapshot.countInRange(endDate.addDays(1), lastMonthEnd) == 0;
+    
+    if (split.firstMonth == split.lastMonth && !(firstWhole && lastWhole)) {
+        split.partialRanges.append(qMakePair(startDate, endDate));
+        split.lastMonth = split.firstMonth - 1;
+        return split;
+    }
+    if (!firstWhole) {
+        split.partialRanges.append(qMakePair(startDate, CategoryMonthCube::monthStart(split.firstMonth + 1).addDays(-1)));
+        ++split.firstMonth;
+    }
+    if (!lastWhole) {
+        split.partialRanges.append(qMakePair(CategoryMonthCube::monthStart(split.lastMonth), endDate));
+        --split.lastMonth;
+    }
+    return split;
+}
+
+QVector<double> ReportService::cubeCategoryTotals(Record::Type type, const QDate& startDate, const QDate& endDate,
+                                                  double& unknownTotal) const {
+    const int categoryCount = m_cube.categoryCount();
+    QVector<double> totals(categoryCount, 0.0);
+    unknownTotal = 0.0;
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return totals;
+    }
+    
+    auto snapshot = m_user->snapshot();
+    auto addRows = [&](const QDate& from, const QDate& to) {
+        double unknown = 0.0;
+        QVector<double> part = snapshot->categoryTotals(from, to, type, &unknown);
+        for (int i = 0; i < categoryCount && i < part.size(); ++i) {
+            totals[i] += part[i];
+        }
+        unknownTotal += unknown;
+    };
+    
+    MonthSplit split = splitByMonth(*snapshot, startDate, endDate);
+    for (const auto& range : split.partialRanges) {
+        addRows(range.first, range.second);
+    }
+    if (split.firstMonth > split.lastMonth) {
+        return totals;
+    }
+    
+    QVector<CategoryMonthCube::Cell> cells = m_cube.categoryTotals(type, split.firstMonth, split.lastMonth);
+    for (int i = 0; i < categoryCount; ++i) {
+        totals[i] += cells[i].amount;
+    }
+    unknownTotal += cells[m_cube.unknownCategory()].amount;
+    
+    return totals;
+}
+
+QMap<QString, double> ReportService::cubeCategoryDistribution(Record::Type type,
+                                                              const QDate& startDate, const QDate& endDate) const {
+    double unknownTotal = 0.0;
+    QVector<double> totals = cubeCategoryTotals(type, startDate, endDate, unknownTotal);
+    return labelCategoryTotals(m_user->getCategoryHierarchy(), totals, unknownTotal);
+}
+
+template <typename T, typename Compute>
+QFuture<T> ReportService::runAsync(Compute compute) {
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    
+    m_pool.start([promise, compute]() {
+        // 排队期间已被新请求取代的任务直接结束，计算中途被取代时聚合提前退出
+        if (!promise->isCanceled()) {
+            T result = compute([promise]() { return promise->isCanceled(); });
+            if (!promise->isCanceled()) {
+                promise->addResult(std::move(result));
+            }
+        }
+        promise->finish();
+    });
+    
+    return future;
+}
+
+QFuture<ReportService::StatisticsData> ReportService::generateStatisticsAsync(const QDate& startDate,
+                                                                              const QDate& endDate) {
+    m_statisticsWatcher.future().cancel();
+    
+    m_pendingStatistics.key = statisticsKey(startDate, endDate);
+    StatisticsData cached;
+    if (lookupCache(m_statisticsCache, m_pendingStatistics.key, cached)) {
+        auto future = readyFuture(cached);
+        m_statisticsWatcher.setFuture(future);
+        return future;
+    }
+    
+    // 快照在GUI线程获取，工作线程只读取这一版本
+    auto snapshot = m_user->snapshot();
+    m_pendingStatistics.version = snapshot->version();
+    auto future = runAsync<StatisticsData>([snapshot, startDate, endDate](const std::function<bool()>& canceled) {
+        return computeStatistics(*snapshot, startDate, endDate, canceled);
+    });
+    m_statisticsWatcher.setFuture(future);
+    return future;
+}
+
+QFuture<ReportService::ChartData> ReportService::generateChartDataAsync(ReportType type, TimeDimension dimension,
+                                                                        const QDate& startDate, const QDate& endDate) {
+    m_chartWatcher.future().cancel();
+    
+    m_pendingChart.key = chartKey(type, dimension, startDate, endDate);
+    ChartData cached;
+    if (lookupCache(m_chartCache, m_pendingChart.key, cached)) {
+        auto future = readyFuture(cached);
+        m_chartWatcher.setFuture(future);
+        return future;
+    }
     
-    // 获取分类统计数据
-    data.categoryExpenses = getCategoryExpenseDistribution(startDate, endDate);
-    data.categoryIncomes = getCategoryIncomeDistribution(startDate, endDate);
+    auto snapshot = m_user->snapshot();
+    m_pendingChart.version = snapshot->version();
+    if (type == ReportType::CategoryAnalysis) {
+        // 分类统计由立方体直接得出，不进入线程池；结果仍经由监视器异步发出
+        auto future = readyFuture(computeChartNow(type, dimension, startDate, endDate));
+        m_chartWatcher.setFuture(future);
+        return future;
+    }
     
-    // 获取交易数量
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
-    data.transactionCount = records.size();
+    if (type == ReportType::BudgetPerformance) {
+        // 预算在GUI线程按值复制，工作线程不访问 User
+        auto future = runAsync<ChartData>([snapshot, budgets = budgetValues(), endDate](const std::function<bool()>&) {
+            return computeBudgetChart(*snapshot, budgets, endDate);
+        });
+        m_chartWatcher.setFuture(future);
+        return future;
+    }
     
+    auto future = runAsync<ChartData>([snapshot, type, dimension, startDate, endDate](const std::function<bool()>& canceled) {
+        return computeChartData(*snapshot, type, dimension, startDate, endDate, canceled);
+    });
+    m_chartWatcher.setFuture(future);
+    return future;
+}
+
+void ReportService::cancelPendingReports() {
+    m_statisticsWatcher.future().cancel();
+    m_chartWatcher.future().cancel();
+}
+
+void ReportService::clearCache() {
+    m_statisticsCache.clear();
+    m_chartCache.clear();
+}
+
+ReportService::CacheKey ReportService::statisticsKey(const QDate& startDate, const QDate& endDate) {
+    return CacheKey{kStatisticsKind, 0, startDate.toJulianDay(), endDate.toJulianDay()};
+}
+
+ReportService::CacheKey ReportService::chartKey(ReportType type, TimeDimension dimension,
+                                                const QDate& startDate, const QDate& endDate) {
+    return CacheKey{static_cast<int>(type), static_cast<int>(dimension),
+                    startDate.toJulianDay(), endDate.toJulianDay()};
+}
+
+void ReportService::validateCache() {
+    quint64 version = m_user->getDataVersion();
+    if (version != m_cacheVersion) {
+        clearCache();
+        m_cacheVersion = version;
+    }
+}
+
+template <typename T>
+bool ReportService::lookupCache(QCache<CacheKey, T>& cache, const CacheKey& key, T& result) {
+    validateCache();
+    if (T* cached = cache.object(key)) {
+        ++m_cacheStats.hits;
+        result = *cached;
+        return true;
+    }
+    ++m_cacheStats.misses;
+    return false;
+}
+
+template <typename T>
+void ReportService::storeInCache(QCache<CacheKey, T>& cache, const PendingRequest& request, const T& result) {
+    // 计算期间数据已变化时结果只发出、不缓存
+    validateCache();
+    if (request.version == m_cacheVersion) {
+        cache.insert(request.key, new T(result));
+    }
+}
+
+QVector<Budget> ReportService::budgetValues() const {
+    QVector<Budget> budgets;
+    budgets.reserve(m_user->getAllBudgets().size());
+    for (const auto& budget : m_user->getAllBudgets()) {
+        budgets.append(*budget);
+    }
+    return budgets;
+}
+
+ReportService::ChartData ReportService::computeChartNow(ReportType type, TimeDimension dimension,
+                                                        const QDate& startDate, const QDate& endDate) {
+    if (type == ReportType::CategoryAnalysis) {
+        return categoryChartData(cubeCategoryDistribution(Record::Type::Expense, startDate, endDate), dimension);
+    }
+    if (type == ReportType::BudgetPerformance) {
+        return computeBudgetChart(*m_user->snapshot(), budgetValues(), endDate);
+    }
+    return computeChartData(*m_user->snapshot(), type, dimension, startDate, endDate);
+}
+
+ReportService::StatisticsData ReportService::generateStatistics(const QDate& startDate, const QDate& endDate) {
+    CacheKey key = statisticsKey(startDate, endDate);
+    StatisticsData data;
+    if (!lookupCache(m_statisticsCache, key, data)) {
+        data = computeStatistics(*m_user->snapshot(), startDate, endDate);
+        m_statisticsCache.insert(key, new StatisticsData(data));
+    }
     emit reportGenerated(data);
     return data;
 }
 
-ReportService::ChartData ReportService::generateChartData(ReportType type, TimeDimension dimension, 
+ReportService::ChartData ReportService::generateChartData(ReportType type, TimeDimension dimension,
                                                          const QDate& startDate, const QDate& endDate) {
+    CacheKey key = chartKey(type, dimension, startDate, endDate);
     ChartData chartData;
+    if (!lookupCache(m_chartCache, key, chartData)) {
+        chartData = computeChartNow(type, dimension, startDate, endDate);
+        m_chartCache.insert(key, new ChartData(chartData));
+    }
+    emit chartDataReady(chartData);
+    return chartData;
+}
+
+QMap<QDate, double> ReportService::getExpenseTrend(const QDate& startDate, const QDate& endDate) {
+    return computeTrend(*m_user->snapshot(), Record::Type::Expense, startDate, endDate);
+}
+
+QMap<QDate, double> ReportService::getIncomeTrend(const QDate& startDate, const QDate& endDate) {
+    return computeTrend(*m_user->snapshot(), Record::Type::Income, startDate, endDate);
+}
+
+QMap<QString, double> ReportService::getCategoryExpenseDistribution(const QDate& startDate, const QDate& endDate) {
+    return cubeCategoryDistribution(Record::Type::Expense, startDate, endDate);
+}
+
+QMap<QString, double> ReportService::getCategoryIncomeDistribution(const QDate& startDate, const QDate& endDate) {
+    return cubeCategoryDistribution(Record::Type::Income, startDate, endDate);
+}
+
+QMap<QString, double> ReportService::getCategoryExpenseRollup(const QDate& startDate, const QDate& endDate) {
+    const auto& hierarchy = m_user->getCategoryHierarchy();
+    
+    // 先按分类的先序编号累计，再对每个子树做一次区间求和
+    double unknownTotal = 0.0;
+    QVector<double> totals = cubeCategoryTotals(Record::Type::Expense, startDate, endDate, unknownTotal);
+    return labelCategoryTotals(hierarchy, hierarchy.rollup(totals), unknownTotal);
+}
+
+QMap<QDate, double> ReportService::getCategoryMonthlyTrend(const QString& categoryId, Record::Type type,
+                                                           const QDate& startDate, const QDate& endDate) const {
+    QMap<QDate, double> trend;
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return trend;
+    }
+    
+    // 子树在先序编号中是连续区间，逐月合计只需读取立方体中相邻的几行
+    int firstCategory = 0;
+    int endCategory = m_cube.unknownCategory() + 1;
+    if (!categoryId.isEmpty()) {
+        const auto& hierarchy = m_user->getCategoryHierarchy();
+        firstCategory = hierarchy.indexOf(categoryId);
+        if (firstCategory < 0) {
+            return trend;
+        }
+        endCategory = hierarchy.subtreeEnd(firstCategory);
+    }
+    
+    int firstMonth = CategoryMonthCube::monthOf(startDate);
+    int lastMonth = CategoryMonthCube::monthOf(endDate);
+    auto series = m_cube.monthSeries(type, firstCategory, endCategory, firstMonth, lastMonth);
+    for (int i = 0; i < series.size(); ++i) {
+        if (series[i].count > 0) {
+            trend.insert(CategoryMonthCube::monthStart(firstMonth + i), series[i].amount);
+        }
+    }
+    
+    return trend;
+}
+
+QVector<QuantileSketch> ReportService::categoryAmountSketches(Record::Type type,
+                                                             const QDate& startDate, const QDate& endDate) const {
+    const int unknown = m_cube.unknownCategory();
+    QVector<QuantileSketch> sketches(unknown + 1);
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return sketches;
+    }
+    
+    // 首尾不足整月的部分逐行插入，整月直接合并已维护的草图
+    auto snapshot = m_user->snapshot();
+    MonthSplit split = splitByMonth(*snapshot, startDate, endDate);
+    const quint8 kind = static_cast<quint8>(type);
+    for (const auto& range : split.partialRanges) {
+        snapshot->forEachRowInRange(range.first, range.second, [&](const LedgerChunk& chunk, int row) {
+            if (chunk.kinds[row] == kind) {
+                int category = chunk.categories[row];
+                sketches[category >= 0 && category < unknown ? category : unknown].insert(chunk.amounts[row]);
+            }
+        });
+    }
+    for (int month = split.firstMonth; month <= split.lastMonth; ++month) {
+        for (int category = 0; category <= unknown; ++category) {
+            auto it = m_amountSketches.constFind(sketchKey(type, category, month));
+            if (it != m_amountSketches.constEnd()) {
+                sketches[category].merge(it.value());
+            }
+        }
+    }
+    
+    return sketches;
+}
+
+ReportService::AmountQuantiles ReportService::getAmountQuantiles(Record::Type type,
+                                                                 const QDate& startDate, const QDate& endDate,
+                                                                 const QString& categoryId) const {
+    int firstCategory = 0;
+    int endCategory = m_cube.unknownCategory() + 1;
+    if (!categoryId.isEmpty()) {
+        const auto& hierarchy = m_user->getCategoryHierarchy();
+        firstCategory = hierarchy.indexOf(categoryId);
+        if (firstCategory < 0) {
+            return AmountQuantiles();
+        }
+        endCategory = hierarchy.subtreeEnd(firstCategory);
+    }
+    
+    QVector<QuantileSketch> sketches = categoryAmountSketches(type, startDate, endDate);
+    QuantileSketch merged;
+    for (int category = firstCategory; category < endCategory; ++category) {
+        merged.merge(sketches[category]);
+    }
+    return sketchQuantiles(merged);
+}
+
+QMap<QString, ReportService::AmountQuantiles> ReportService::getCategoryAmountQuantiles(Record::Type type,
+                                                                                       const QDate& startDate,
+                                                                                       const QDate& endDate) const {
+    QMap<QString, AmountQuantiles> result;
+    const auto& hierarchy = m_user->getCategoryHierarchy();
+    QVector<QuantileSketch> sketches = categoryAmountSketches(type, startDate, endDate);
+    for (int category = 0; category < sketches.size(); ++category) {
+        if (!sketches[category].isEmpty()) {
+            QString label = category == m_cube.unknownCategory() ? QString("未知分类") : hierarchy.displayPathAt(category);
+            result.insert(label, sketchQuantiles(sketches[category]));
+        }
+    }
+    return result;
+}
+
+QMap<QString, double> ReportService::getExpenseByNote(const QDate& startDate, const QDate& endDate) {
+    // 备注已驻留，按编号分组只比较整数
+    QHash<int, double> totalsByNote;
+    const quint8 expense = static_cast<quint8>(Record::Type::Expense);
+    m_user->snapshot()->forEachRowInRange(startDate, endDate, [&](const LedgerChunk& chunk, int row) {
+        if (chunk.kinds[row] == expense && chunk.notes[row] != 0) {
+            totalsByNote[chunk.notes[row]] += chunk.amounts[row];
+        }
+    });
+    
+    QMap<QString, double> result;
+    const StringPool& notes = StringPool::notes();
+    for (auto it = totalsByNote.constBegin(); it != totalsByNote.constEnd(); ++it) {
+        result[notes.at(it.key())] = it.value();
+    }
+    
+    return result;
+}
+
+QVector<ReportService::SpendingDestination> ReportService::getTopSpendingDestinations(const QDate& startDate,
+                                                                                     const QDate& endDate, int k) {
+    return computeTopDestinations(*m_user->snapshot(), startDate, endDate, k);
+}
+
+QString ReportService::normalizeNote(const QString& note) {
+    return note.simplified().toLower();
+}
+
+QVector<ReportService::SpendingDestination> ReportService::computeTopDestinations(const LedgerSnapshot& snapshot,
+                                                                                  const QDate& startDate,
+                                                                                  const QDate& endDate, int k,
+                                                                                  int exactKeyLimit) {
+    QVector<SpendingDestination> result;
+    if (k <= 0 || !startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return result;
+    }
+    
+    // 以规范化文本的哈希为键，备注编号到键的缓存有上限，满了就清空重来
+    const StringPool& notes = StringPool::notes();
+    QHash<int, quint64> keyCache;
+    auto keyOf = [&](int noteId) {
+        auto it = keyCache.constFind(noteId);
+        if (it != keyCache.constEnd()) {
+            return it.value();
+        }
+        if (keyCache.size() >= kNoteKeyCacheSize) {
+            keyCache.clear();
+        }
+        quint64 key = noteKey(normalizeNote(notes.at(noteId)));
+        keyCache.insert(noteId, key);
+        return key;
+    };
+    
+    const quint8 expense = static_cast<quint8>(Record::Type::Expense);
+    auto forEachExpense = [&](auto&& add) {
+        snapshot.forEachRowInRange(startDate, endDate, [&](const LedgerChunk& chunk, int row) {
+            if (chunk.kinds[row] == expense && chunk.notes[row] != 0) {
+                quint64 key = keyOf(chunk.notes[row]);
+                if (key != 0) {
+                    add(key, chunk.amounts[row], chunk.notes[row]);
+                }
+            }
+        });
+    };
+    
+    auto appendDestination = [&](int noteId, double amount, double error) {
+        SpendingDestination destination;
+        destination.note = notes.at(noteId);
+        destination.amount = amount;
+        destination.error = error;
+        result.append(destination);
+    };
+    
+    // 不同去向不超过 exactKeyLimit 时精确分组；超过后停止分组，改用近似统计重新扫描
+    if (exactKeyLimit > 0) {
+        QHash<quint64, DestinationTotal> totals;
+        bool overflow = false;
+        forEachExpense([&](quint64 key, double amount, int noteId) {
+            if (overflow) {
+                return;
+            }
+            auto it = totals.find(key);
+            if (it == totals.end()) {
+                if (totals.size() >= exactKeyLimit) {
+                    overflow = true;
+                    totals.clear();
+                    return;
+                }
+                it = totals.insert(key, DestinationTotal{noteId, 0.0});
+            }
+            it->amount += amount;
+        });
+        if (!overflow) {
+            for (const auto& total : totals) {
+                appendDestination(total.noteId, total.amount, 0.0);
+            }
+            std::sort(result.begin(), result.end(), [](const SpendingDestination& a, const SpendingDestination& b) {
+                return a.amount > b.amount;
+            });
+            if (result.size() > k) {
+                result.resize(k);
+            }
+            return result;
+        }
+    }
+    
+    // 计数器数量固定，只为留下的计数器取备注文本
+    SpaceSaving counters(k * kCountersPerDestination);
+    forEachExpense([&](quint64 key, double amount, int noteId) {
+        counters.add(key, amount, noteId);
+    });
+    for (const auto& counter : counters.top(k)) {
+        appendDestination(counter.label, counter.count, counter.error);
+    }
+    return result;
+}
+
+QMap<QString, ReportService::BudgetUsage> ReportService::getBudgetUsageReport(const QDate& date) {
+    QMap<QString, BudgetUsage> budgetUsage;
+    
+    // 只计算该日期所在周期内的预算（含未设置起止日期的周期预算），实际支出来自快照聚合
+    QVector<Budget> budgets;
+    for (const auto& budget : m_user->getAllBudgets()) {
+        if (User::budgetCoversDay(*budget, date.toJulianDay())) {
+            budgets.append(*budget);
+        }
+    }
+    
+    const auto performance = computeBudgetPerformance(*m_user->snapshot(), budgets, date, 0);
+    for (const auto& item : performance) {
+        const auto& current = item.periods.last();
+        // 同一分类、同一周期类型可以有多个预算，按预算ID区分
+        BudgetUsage usage;
+        usage.label = item.label;
+        usage.usage = current.budgeted > 0 ? current.actual / current.budgeted : 0.0;
+        budgetUsage.insert(item.budgetId, usage);
+    }
+    
+    return budgetUsage;
+}
+
+QVector<ReportService::BudgetPerformance> ReportService::getBudgetPerformance(const QDate& date, int historyPeriods) {
+    return computeBudgetPerformance(*m_user->snapshot(), budgetValues(), date, historyPeriods);
+}
+
+ReportService::StatisticsData ReportService::computeStatistics(const LedgerSnapshot& snapshot,
+                                                               const QDate& startDate, const QDate& endDate,
+                                                               const std::function<bool()>& canceled) {
+    // 收支、分类和笔数由并行聚合一次得出
+    auto totals = LedgerAggregator::aggregate(snapshot, startDate, endDate, nullptr, 0, canceled);
+    
+    StatisticsData data;
+    data.totalIncome = totals.totalIncome;
+    data.totalExpense = totals.totalExpense;
+    data.transactionCount = totals.transactionCount;
+    data.balance = data.totalIncome - data.totalExpense;
+    int days = getDaysInPeriod(startDate, endDate);
+    data.avgDailyExpense = days > 0 ? data.totalExpense / days : 0.0;
+    data.categoryExpenses = labelCategoryTotals(snapshot.hierarchy(), totals.categoryExpense, totals.unknownExpense);
+    data.categoryIncomes = labelCategoryTotals(snapshot.hierarchy(), totals.categoryIncome, totals.unknownIncome);
+    
+    return data;
+}
+
+ReportService::ChartData ReportService::computeChartData(const LedgerSnapshot& snapshot, ReportType type,
+                                                         TimeDimension dimension,
+                                                         const QDate& startDate, const QDate& endDate,
+                                                         const std::function<bool()>& canceled) {
+    ChartData chartData;
+    chartData.type = type;
+    chartData.dimension = dimension;
     
     switch (type) {
         case ReportType::IncomeExpense:
             chartData.title = "收支分析";
             chartData.unit = "元";
-            chartData.values = {m_user->getTotalIncome(startDate, endDate), 
-                               m_user->getTotalExpense(startDate, endDate)};
+            chartData.values = {snapshot.totalInRange(startDate, endDate, Record::Type::Income),
+                               snapshot.totalInRange(startDate, endDate, Record::Type::Expense)};
             chartData.labels = {"收入", "支出"};
             chartData.colors = {QColor("#27AE60"), QColor("#E74C3C")};
             break;
-            
+    
         case ReportType::CategoryAnalysis:
-            chartData.title = "分类统计";
+            chartData = categoryChartData(computeCategoryDistribution(snapshot, Record::Type::Expense,
+                                                                      startDate, endDate, canceled), dimension);
+            break;
+    
+        case ReportType::TrendAnalysis:
+            chartData.title = "趋势分析";
             chartData.unit = "元";
             {
-                auto categoryData = getCategoryExpenseDistribution(startDate, endDate);
-                for (auto it = categoryData.begin(); it != categoryData.end(); ++it) {
-                    chartData.values.append(it.value());
-                    chartData.labels.append(it.key());
+                // 一次聚合得到每日收支，再按统计粒度顺序合并为日历区间
+                auto totals = LedgerAggregator::aggregate(snapshot, startDate, endDate, nullptr, 0, canceled);
+                int day = 0;
+                while (day < totals.dayCount()) {
+                    QDate bucket = bucketStart(totals.dateAt(day), dimension);
+                    qint64 next = nextBucketStart(bucket, dimension).toJulianDay() - totals.firstDay;
+                    int stop = int(std::min<qint64>(next, totals.dayCount()));
+                    double expense = 0.0;
+                    double income = 0.0;
+                    for (; day < stop; ++day) {
+                        expense += totals.dailyExpense[day];
+                        income += totals.dailyIncome[day];
+                    }
+                    // 横轴只保留有收支发生的区间
+                    if (expense == 0.0 && income == 0.0) {
+                        continue;
+                    }
+                    chartData.keys.append(bucket.toJulianDay());
+                    chartData.values.append(expense);
+                    chartData.incomeValues.append(income);
+                    chartData.labels.append(bucketLabel(bucket, dimension));
                 }
             }
             break;
-            
-        case ReportType::TrendAnalysis:
-            chartData.title = "趋势分析";
+    
+        case ReportType::RollingSpend:
+            chartData.title = "滚动支出";
+            chartData.unit = "元";
+            {
+                auto rolling = computeRollingSpend(snapshot, startDate, endDate, {7, 30, 90}, canceled);
+                for (int i = 0; i < rolling.windows.size(); ++i) {
+                    chartData.seriesNames.append(QString("近%1日").arg(rolling.windows[i]));
+                    chartData.seriesValues.append(rolling.totals[i]);
+                }
+                int dayCount = rolling.totals.isEmpty() ? 0 : rolling.totals.first().size();
+                for (int i = 0; i < dayCount; ++i) {
+                    QDate date = startDate.addDays(i);
+                    chartData.keys.append(date.toJulianDay());
+                    chartData.labels.append(date.toString("MM-dd"));
+                }
+            }
+            break;
+    
+        case ReportType::PeriodComparison:
+            chartData.title = "分类环比、同比";
             chartData.unit = "元";
             {
-                auto trendData = getExpenseTrend(startDate, endDate);
-                for (auto it = trendData.begin(); it != trendData.end(); ++it) {
-                    chartData.values.append(it.value());
-                    chartData.labels.append(it.key().toString("MM-dd"));
+                chartData.seriesNames = {"本期", "上月同期", "去年同期"};
+                chartData.seriesValues.resize(3);
+                for (const auto& item : computeCategoryComparison(snapshot, startDate, endDate)) {
+                    chartData.labels.append(item.label);
+                    chartData.values.append(item.current);
+                    chartData.seriesValues[0].append(item.current);
+                    chartData.seriesValues[1].append(item.previousMonth);
+                    chartData.seriesValues[2].append(item.previousYear);
                 }
             }
             break;
-            
+    
+        case ReportType::TopDestinations:
+            chartData.title = "支出去向";
+            chartData.unit = "元";
+            for (const auto& destination : computeTopDestinations(snapshot, startDate, endDate, kTopDestinations)) {
+                chartData.labels.append(destination.note);
+                chartData.values.append(destination.amount);
+            }
+            break;
+    
         default:
             break;
     }
     
-    emit chartDataReady(chartData);
     return chartData;
 }
 
-QMap<QDate, double> ReportService::getExpenseTrend(const QDate& startDate, const QDate& endDate) {
+QMap<QDate, double> ReportService::computeTrend(const LedgerSnapshot& snapshot, Record::Type type,
+                                                const QDate& startDate, const QDate& endDate,
+                                                const std::function<bool()>& canceled) {
     QMap<QDate, double> trendData;
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
-    
-    // 按日期分组统计支出
-    for (const auto& record : records) {
-        if (record->isExpense()) {
-            QDate date = record->getDateTime().date();
-            trendData[date] += record->getAmount();
+    auto totals = LedgerAggregator::aggregate(snapshot, startDate, endDate, nullptr, 0, canceled);
+    const QVector<double>& daily = type == Record::Type::Income ? totals.dailyIncome : totals.dailyExpense;
+    for (int i = 0; i < daily.size(); ++i) {
+        if (daily[i] != 0.0) {
+            trendData.insert(totals.dateAt(i), daily[i]);
         }
     }
     
     return trendData;
 }
 
-QMap<QDate, double> ReportService::getIncomeTrend(const QDate& startDate, const QDate& endDate) {
-    QMap<QDate, double> trendData;
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
-    
-    // 按日期分组统计收入
-    for (const auto& record : records) {
-        if (record->isIncome()) {
-            QDate date = record->getDateTime().date();
-            trendData[date] += record->getAmount();
-        }
+QMap<QString, double> ReportService::computeCategoryDistribution(const LedgerSnapshot& snapshot, Record::Type type,
+                                                                 const QDate& startDate, const QDate& endDate,
+                                                                 const std::function<bool()>& canceled) {
+    auto totals = LedgerAggregator::aggregate(snapshot, startDate, endDate, nullptr, 0, canceled);
+    if (type == Record::Type::Income) {
+        return labelCategoryTotals(snapshot.hierarchy(), totals.categoryIncome, totals.unknownIncome);
     }
-    
-    return trendData;
+    return labelCategoryTotals(snapshot.hierarchy(), totals.categoryExpense, totals.unknownExpense);
 }
 
-QMap<QString, double> ReportService::getCategoryExpenseDistribution(const QDate& startDate, const QDate& endDate) {
-    QMap<QString, double> categoryExpenses;
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
+QVector<ReportService::BudgetPerformance> ReportService::computeBudgetPerformance(const LedgerSnapshot& snapshot,
+                                                                                 const QVector<Budget>& budgets,
+                                                                                 const QDate& date,
+                                                                                 int historyPeriods) {
+    QVector<BudgetPerformance> result;
+    if (budgets.isEmpty()) {
+        return result;
+    }
+    historyPeriods = std::max(0, historyPeriods);
+    const auto& hierarchy = snapshot.hierarchy();
+    
+    // 先确定每个预算的各个周期，同时得到需要聚合的总日期范围
+    QDate firstDay;
+    QDate lastDay;
+    result.reserve(budgets.size());
+    for (const auto& budget : budgets) {
+        TimeDimension dimension = budget.getPeriod() == Budget::Period::Weekly ? TimeDimension::Weekly
+            : budget.getPeriod() == Budget::Period::Yearly ? TimeDimension::Yearly : TimeDimension::Monthly;
+        // 第 i 个周期从开始日起平移 i 个周期；按月、按年从开始日整体平移，月末开始的预算不会逐月漂移
+        QDate anchor = budget.getStartDate().isValid() ? budget.getStartDate() : bucketStart(date, dimension);
+        auto periodStart = [&](int index) {
+            switch (dimension) {
+                case TimeDimension::Weekly:
+                    return anchor.addDays(7 * qint64(index));
+                case TimeDimension::Yearly:
+                    return anchor.addYears(index);
+                default:
+                    return anchor.addMonths(index);
+            }
+        };
+        QDate end = budget.getEndDate().isValid() && budget.getEndDate() >= anchor ? budget.getEndDate() : QDate();
     
-    // 按分类统计支出
-    for (const auto& record : records) {
-        if (record->isExpense()) {
-            QString categoryId = record->getCategoryId();
-            auto category = m_user->getCategory(categoryId);
-            QString categoryName = category ? category->getName() : "未知分类";
-            categoryExpenses[categoryName] += record->getAmount();
+        // 当前周期包含 date；date 晚于结束日时取包含结束日的周期，早于开始日时取第一个周期
+        QDate current = end.isValid() && date > end ? end : date;
+        int index = 0;
+        if (current > anchor) {
+            switch (dimension) {
+                case TimeDimension::Weekly:
+                    index = int(anchor.daysTo(current) / 7);
+                    break;
+                case TimeDimension::Yearly:
+                    index = current.year() - anchor.year();
+                    break;
+                default:
+                    index = (current.year() - anchor.year()) * 12 + current.month() - anchor.month();
+                    break;
+            }
+            if (periodStart(index) > current) {
+                --index;
+            }
         }
+    
+        BudgetPerformance item;
+        item.budgetId = budget.getId();
+        item.categoryId = budget.getCategoryId();
+        QString categoryName = hierarchy.indexOf(item.categoryId) >= 0
+            ? hierarchy.displayPath(item.categoryId) : QString("未知分类");
+        item.label = QString("%1（%2）").arg(categoryName, budget.getPeriodString());
+        // 历史周期为当前周期之前的同类周期
+        for (int k = historyPeriods; k >= 0; --k) {
+            BudgetPeriodPerformance period;
+            period.startDate = periodStart(index - k);
+            period.endDate = periodStart(index - k + 1).addDays(-1);
+            period.budgeted = budget.getTotalAmount();
+            item.periods.append(period);
+        }
+        // 当前周期不超过预算结束日
+        if (end.isValid() && end < item.periods.last().endDate) {
+            item.periods.last().endDate = end;
+        }
+    
+        if (!firstDay.isValid() || item.periods.first().startDate < firstDay) {
+            firstDay = item.periods.first().startDate;
+        }
+        if (!lastDay.isValid() || item.periods.last().endDate > lastDay) {
+            lastDay = item.periods.last().endDate;
+        }
+        result.append(item);
     }
     
-    return categoryExpenses;
+    // 一次按分类、按日聚合；每个预算分类的子树只求一次前缀和
+    auto daily = LedgerAggregator::categoryDaily(snapshot, firstDay, lastDay, Record::Type::Expense);
+    QHash<QString, QVector<double>> prefixByCategory;
+    for (auto& item : result) {
+        if (!prefixByCategory.contains(item.categoryId)) {
+            int index = hierarchy.indexOf(item.categoryId);
+            prefixByCategory.insert(item.categoryId, index >= 0
+                ? daily.prefixSums(index, hierarchy.subtreeEnd(index))
+                : QVector<double>(daily.dayCount + 1, 0.0));
+        }
+        const QVector<double>& prefix = prefixByCategory[item.categoryId];
+        for (auto& period : item.periods) {
+            int begin = int(std::clamp<qint64>(period.startDate.toJulianDay() - daily.firstDay, 0, daily.dayCount));
+            int stop = int(std::clamp<qint64>(period.endDate.toJulianDay() - daily.firstDay + 1, 0, daily.dayCount));
+            period.actual = stop > begin ? prefix[stop] - prefix[begin] : 0.0;
+        }
+    }
+    
+    return result;
 }
 
-QMap<QString, double> ReportService::getCategoryIncomeDistribution(const QDate& startDate, const QDate& endDate) {
-    QMap<QString, double> categoryIncomes;
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
+ReportService::RollingSpend ReportService::computeRollingSpend(const LedgerSnapshot& snapshot,
+                                                               const QDate& startDate, const QDate& endDate,
+                                                               const QVector<int>& windows,
+                                                               const std::function<bool()>& canceled) {
+    RollingSpend result;
+    result.startDate = startDate;
+    result.windows = windows;
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate || windows.isEmpty()) {
+        return result;
+    }
     
-    // 按分类统计收入
-    for (const auto& record : records) {
-        if (record->isIncome()) {
-            QString categoryId = record->getCategoryId();
-            auto category = m_user->getCategory(categoryId);
-            QString categoryName = category ? category->getName() : "未知分类";
-            categoryIncomes[categoryName] += record->getAmount();
+    // 向前多取最长窗口的天数，使范围第一天的窗口也是完整的
+    int longest = std::max(1, *std::max_element(windows.cbegin(), windows.cend()));
+    QDate from = startDate.addDays(1 - longest);
+    int span = int(from.daysTo(endDate) + 1);
+    auto totals = LedgerAggregator::aggregate(snapshot, from, endDate, nullptr, 0, canceled);
+    QVector<double> daily(span, 0.0);
+    int offset = int(totals.firstDay - from.toJulianDay());
+    for (int i = 0; i < totals.dayCount(); ++i) {
+        daily[offset + i] = totals.dailyExpense[i];
+    }
+    
+    // 每个窗口一次滑动：加入新的一天，移出窗口外的一天
+    for (int window : windows) {
+        window = std::max(1, window);
+        QVector<double> series(span - (longest - 1), 0.0);
+        double sum = 0.0;
+        for (int day = 0; day < span; ++day) {
+            sum += daily[day];
+            if (day >= window) {
+                sum -= daily[day - window];
+            }
+            if (day >= longest - 1) {
+                series[day - (longest - 1)] = sum;
+            }
         }
+        result.totals.append(series);
     }
     
-    return categoryIncomes;
+    return result;
 }
 
-QMap<QString, double> ReportService::getBudgetUsageReport(const QDate& date) {
-    QMap<QString, double> budgetUsage;
-    auto budgets = m_user->getAllBudgets();
+QVector<ReportService::CategoryComparison> ReportService::computeCategoryComparison(const LedgerSnapshot& snapshot,
+                                                                                    const QDate& startDate,
+                                                                                    const QDate& endDate) {
+    QVector<CategoryComparison> result;
+    if (!startDate.isValid() || !endDate.isValid() || startDate > endDate) {
+        return result;
+    }
     
-    // 计算每个预算的使用情况
-    for (const auto& budget : budgets) {
-        if (budget->getStartDate() <= date && budget->getEndDate() >= date) {
-            auto category = m_user->getCategory(budget->getCategoryId());
-            QString categoryName = category ? category->getName() : "未知分类";
-            budgetUsage[categoryName] = budget->getUsagePercentage();
+    // 一次按分类、按日聚合覆盖去年同期至今，三段合计都由前缀和相减得出
+    QDate yearStart = startDate.addYears(-1);
+    auto daily = LedgerAggregator::categoryDaily(snapshot, yearStart, endDate, Record::Type::Expense);
+    auto dayIndex = [&](const QDate& date) {
+        return int(std::clamp<qint64>(date.toJulianDay() - daily.firstDay, 0, daily.dayCount));
+    };
+    auto rangeTotal = [&](const QVector<double>& prefix, const QDate& from, const QDate& to) {
+        return prefix[dayIndex(to.addDays(1))] - prefix[dayIndex(from)];
+    };
+    
+    // 先求各分类自身的三段合计，再按层级汇总，父分类得到含全部子分类的合计
+    QVector<double> current(daily.categoryCount, 0.0);
+    QVector<double> previousMonth(daily.categoryCount, 0.0);
+    QVector<double> previousYear(daily.categoryCount, 0.0);
+    for (int category = 0; category < daily.categoryCount; ++category) {
+        QVector<double> prefix = daily.prefixSums(category, category + 1);
+        current[category] = rangeTotal(prefix, startDate, endDate);
+        previousMonth[category] = rangeTotal(prefix, startDate.addMonths(-1), endDate.addMonths(-1));
+        previousYear[category] = rangeTotal(prefix, yearStart, endDate.addYears(-1));
+    }
+    const auto& hierarchy = snapshot.hierarchy();
+    current = hierarchy.rollup(current);
+    previousMonth = hierarchy.rollup(previousMonth);
+    previousYear = hierarchy.rollup(previousYear);
+    
+    for (int category = 0; category < daily.categoryCount; ++category) {
+        CategoryComparison item;
+        item.current = current[category];
+        item.previousMonth = previousMonth[category];
+        item.previousYear = previousYear[category];
+        if (item.current != 0.0 || item.previousMonth != 0.0 || item.previousYear != 0.0) {
+            item.label = hierarchy.displayPathAt(category);
+            result.append(item);
         }
     }
     
-    return budgetUsage;
+    return result;
 }
 
-double ReportService::calculateAverageDailyExpense(const QDate& startDate, const QDate& endDate) {
-    int days = getDaysInPeriod(startDate, endDate);
-    if (days <= 0) return 0.0;
-    
-    double totalExpense = m_user->getTotalExpense(startDate, endDate);
-    return totalExpense / days;
+ReportService::ChartData ReportService::computeBudgetChart(const LedgerSnapshot& snapshot,
+                                                           const QVector<Budget>& budgets, const QDate& date) {
+    ChartData chartData;
+    chartData.type = ReportType::BudgetPerformance;
+    chartData.title = "预算执行";
+    chartData.unit = "元";
+    for (const auto& item : computeBudgetPerformance(snapshot, budgets, date, 0)) {
+        chartData.labels.append(item.label);
+        chartData.values.append(item.periods.last().actual);
+        chartData.budgetValues.append(item.periods.last().budgeted);
+    }
+    return chartData;
+}
+
+QDate ReportService::bucketStart(const QDate& date, TimeDimension dimension) {
+    switch (dimension) {
+        case TimeDimension::Weekly:
+            return date.addDays(1 - date.dayOfWeek());
+        case TimeDimension::Monthly:
+            return QDate(date.year(), date.month(), 1);
+        case TimeDimension::Yearly:
+            return QDate(date.year(), 1, 1);
+        default:
+            return date;
+    }
+}
+
+QDate ReportService::nextBucketStart(const QDate& bucket, TimeDimension dimension) {
+    switch (dimension) {
+        case TimeDimension::Weekly:
+            return bucket.addDays(7);
+        case TimeDimension::Monthly:
+            return bucket.addMonths(1);
+        case TimeDimension::Yearly:
+            return bucket.addYears(1);
+        default:
+            return bucket.addDays(1);
+    }
+}
+
+QString ReportService::bucketLabel(const QDate& bucket, TimeDimension dimension) {
+    switch (dimension) {
+        case TimeDimension::Weekly:
+            {
+                // ISO周，年初的几天可能属于上一年的最后一周
+                int weekYear = 0;
+                int week = bucket.weekNumber(&weekYear);
+                return QString("%1年第%2周").arg(weekYear).arg(week);
+            }
+        case TimeDimension::Monthly:
+            return bucket.toString("yyyy-MM");
+        case TimeDimension::Yearly:
+            return bucket.toString("yyyy");
+        default:
+            return bucket.toString("MM-dd");
+    }
 }
 
 int ReportService::getDaysInPeriod(const QDate& startDate, const QDate& endDate) {
     return startDate.daysTo(endDate) + 1;
-}
\ No newline at end of file
+}
@@ -6,9 +6,20 @@
 #include <QVector>
 #include <QMap>
 #include <QColor>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QCache>
+#include <QHash>
+#include <QSet>
 #include <memory>
+#include <functional>
 #include "../models/User.h"
 #include "../models/Record.h"
+#include "../models/LedgerSnapshot.h"
+#include "../models/CategoryMonthCube.h"
+#include "../models/QuantileSketch.h"
+#include "../models/SpendingForecast.h"
 
 class ReportService : public QObject {
     Q_OBJECT
@@ -25,11 +36,21 @@ public:
         IncomeExpense,
         CategoryAnalysis,
         TrendAnalysis,
-        BudgetPerformance
+        BudgetPerformance,
+        RollingSpend,         // 近7/30/90日滚动支出
+        PeriodComparison,     // 分类环比、同比
+        TopDestinations       // 支出去向（按备注）排行
     };
     
     struct ChartData {
-        QVector<double> values;
+        ReportType type = ReportType::IncomeExpense;
+        TimeDimension dimension = TimeDimension::Daily;
+        QVector<double> values;           // 趋势分析：每个区间的支出
+        QVector<double> incomeValues;     // 趋势分析：每个区间的收入
+        QVector<double> keys;             // 趋势分析：区间起始日（儒略日）
+        QVector<double> budgetValues;     // 预算执行：各预算当前周期的预算金额，values 为实际支出
+        QVector<QString> seriesNames;     // 滚动支出、同比环比：多条序列的名称
+        QVector<QVector<double>> seriesValues;
         QVector<QString> labels;
         QVector<QColor> colors;
         QString title;
@@ -46,7 +67,106 @@ public:
         int transactionCount;
     };
     
+    // 预算执行：一个预算周期的预算金额与实际支出
+    struct BudgetPeriodPerformance {
+        QDate startDate;
+        QDate endDate;
+        double budgeted = 0.0;
+        double actual = 0.0;
+    };
+    
+    struct BudgetPerformance {
+        QString budgetId;
+        QString categoryId;
+        QString label;                                 // 如 "餐饮（月度）"
+        QVector<BudgetPeriodPerformance> periods;      // 由早到晚，最后一项为当前周期
+    };
+    
+    static constexpr int kBudgetHistoryPeriods = 6;
+    
+    // 预算使用率：当前周期实际支出占预算金额的比例
+    struct BudgetUsage {
+        QString label;                                 // 同 BudgetPerformance::label
+        double usage = 0.0;
+    };
+    
+    // 滚动窗口支出：每个窗口长度（天）一条序列，第 i 项为截至 startDate + i 天的窗口合计
+    struct RollingSpend {
+        QDate startDate;
+        QVector<int> windows;
+        QVector<QVector<double>> totals;
+    };
+    
+    // 分类支出与上月同期、去年同期（日期范围整体平移一个月、一年）的比较；
+    // 每个分类（按先序）一项，父分类的金额含全部子分类
+    struct CategoryComparison {
+        QString label;
+        double current = 0.0;
+        double previousMonth = 0.0;
+        double previousYear = 0.0;
+        
+        double monthOverMonth() const { return current - previousMonth; }
+        double yearOverYear() const { return current - previousYear; }
+    };
+    
+    // 交易金额的中位数和高分位数
+    struct AmountQuantiles {
+        quint64 count = 0;
+        double median = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+    };
+    
+    // 支出去向：规范化备注（去除多余空白、不区分大小写）相同的支出合为一项
+    struct SpendingDestination {
+        QString note;            // 该项中首次出现的原始备注（近似统计时为该项最近一次进入计数器时的写法）
+        double amount = 0.0;
+        double error = 0.0;      // 近似统计时 amount 可能高估的上界，精确统计时为 0
+    };
+    
+    static constexpr int kTopDestinations = 10;
+    // 范围内不同去向不超过该值时精确分组，否则用 Space-Saving 近似统计；
+    // 两种方式的内存分别不超过该值和 k × kCountersPerDestination 个键，与记录数无关
+    static constexpr int kExactDestinationKeys = 50000;
+    static constexpr int kCountersPerDestination = 20;
+    
+    // 进行中预算的周期末支出预测
+    struct BudgetForecast {
+        QString budgetId;
+        QString categoryId;
+        QDate startDate;
+        QDate endDate;
+        double budgeted = 0.0;
+        double spent = 0.0;          // 周期内已发生的支出
+        double projected = 0.0;      // 已发生的支出加上剩余日子的预测支出；未设置结束日期时等于已发生的支出
+        
+        bool willExceed() const { return projected > budgeted; }
+    };
+    
+    // 首次预测某个预算时用于拟合的历史天数
+    static constexpr int kForecastHistoryDays = 56;
+    
+    // 报告结果缓存的命中统计
+    struct CacheStats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+    
     explicit ReportService(std::shared_ptr<User> user, QObject *parent = nullptr);
+    ~ReportService();
+    
+    // 异步生成：在线程池中基于当前账本快照计算，新请求会取消尚未完成的同类请求，
+    // 结果通过 reportGenerated / chartDataReady 在GUI线程发出
+    QFuture<StatisticsData> generateStatisticsAsync(const QDate& startDate, const QDate& endDate);
+    QFuture<ChartData> generateChartDataAsync(ReportType type, TimeDimension dimension,
+                                              const QDate& startDate, const QDate& endDate);
+    void cancelPendingReports();
+    
+    // 统计报告和图表按（报告种类，时间粒度，起止日期）缓存最近使用的结果，
+    // 用户数据版本变化后全部失效；统计报告和图表各保留 kCacheCapacity 条
+    static constexpr int kCacheCapacity = 32;
+    CacheStats cacheStats() const { return m_cacheStats; }
+    void clearCache();
     
     // 生成统计报告
     StatisticsData generateStatistics(const QDate& startDate, const QDate& endDate);
@@ -59,27 +179,172 @@ public:
     QMap<QDate, double> getExpenseTrend(const QDate& startDate, const QDate& endDate);
     QMap<QDate, double> getIncomeTrend(const QDate& startDate, const QDate& endDate);
     
-    // 分类分析
+    // 分类分析：由分类 × 月份立方体得出，范围两端不足整月的部分才读取快照
     QMap<QString, double> getCategoryExpenseDistribution(const QDate& startDate, const QDate& endDate);
     QMap<QString, double> getCategoryIncomeDistribution(const QDate& startDate, const QDate& endDate);
+    // 父分类汇总全部子分类的支出
+    QMap<QString, double> getCategoryExpenseRollup(const QDate& startDate, const QDate& endDate);
+    // 分类（含子分类）逐月合计，键为月份第一天；categoryId 为空时统计全部分类
+    QMap<QDate, double> getCategoryMonthlyTrend(const QString& categoryId, Record::Type type,
+                                                const QDate& startDate, const QDate& endDate) const;
+    // 交易金额分位数：合并每个分类 × 月份的分位数草图得出，范围两端不足整月的部分读取快照；
+    // categoryId 为空时统计全部分类，否则包含其子分类
+    AmountQuantiles getAmountQuantiles(Record::Type type, const QDate& startDate, const QDate& endDate,
+                                       const QString& categoryId = QString()) const;
+    // 每个分类（不含子分类）各自的金额分位数
+    QMap<QString, AmountQuantiles> getCategoryAmountQuantiles(Record::Type type,
+                                                              const QDate& startDate, const QDate& endDate) const;
+    // 按备注（商户、用途）分组的支出
+    QMap<QString, double> getExpenseByNote(const QDate& startDate, const QDate& endDate);
+    // 支出金额最多的 k 个去向，按金额从大到小
+    QVector<SpendingDestination> getTopSpendingDestinations(const QDate& startDate, const QDate& endDate,
+                                                           int k = kTopDestinations);
+    
+    // 预算执行情况，按预算ID索引
+    QMap<QString, BudgetUsage> getBudgetUsageReport(const QDate& date);
+    // 全部预算的当前周期及之前 historyPeriods 个同类周期的预算与实际支出
+    QVector<BudgetPerformance> getBudgetPerformance(const QDate& date, int historyPeriods = kBudgetHistoryPeriods);
+    
+    // 支出预测：每个预算（含子分类）维护一个按日指数平滑、带星期季节项的模型，
+    // 首次使用时由近 kForecastHistoryDays 天的每日聚合拟合，之后随新增记录增量更新
+    QVector<BudgetForecast> getBudgetForecasts(const QDate& date = QDate::currentDate());
+    // 预算周期不包含 date 时只填写预算信息，不做预测
+    BudgetForecast getBudgetForecast(const std::shared_ptr<Budget>& budget, const QDate& date = QDate::currentDate());
+    
+    // 以下计算只读取不可变快照，可在任意线程执行；canceled 返回 true 时提前结束
+    static StatisticsData computeStatistics(const LedgerSnapshot& snapshot,
+                                            const QDate& startDate, const QDate& endDate,
+                                            const std::function<bool()>& canceled = std::function<bool()>());
+    static ChartData computeChartData(const LedgerSnapshot& snapshot, ReportType type, TimeDimension dimension,
+                                      const QDate& startDate, const QDate& endDate,
+                                      const std::function<bool()>& canceled = std::function<bool()>());
+    static QMap<QDate, double> computeTrend(const LedgerSnapshot& snapshot, Record::Type type,
+                                            const QDate& startDate, const QDate& endDate,
+                                            const std::function<bool()>& canceled = std::function<bool()>());
+    static QMap<QString, double> computeCategoryDistribution(const LedgerSnapshot& snapshot, Record::Type type,
+                                                             const QDate& startDate, const QDate& endDate,
+                                                             const std::function<bool()>& canceled = std::function<bool()>());
     
-    // 预算执行情况
-    QMap<QString, double> getBudgetUsageReport(const QDate& date);
+    // 预算按值传入，实际支出由一次按分类、按日的聚合得出，不逐个预算扫描记录。
+    // 周期从预算开始日起按预算的周、月、年依次排列，当前周期为包含 date 的一个且不超过结束日；
+    // 未设置开始日期的预算以 date 所在的自然周期为当前周期
+    static QVector<BudgetPerformance> computeBudgetPerformance(const LedgerSnapshot& snapshot,
+                                                               const QVector<Budget>& budgets,
+                                                               const QDate& date, int historyPeriods);
+    // 基于每日聚合数组，耗时只与天数和分类数有关，与记录数无关
+    static RollingSpend computeRollingSpend(const LedgerSnapshot& snapshot, const QDate& startDate, const QDate& endDate,
+                                            const QVector<int>& windows = {7, 30, 90},
+                                            const std::function<bool()>& canceled = std::function<bool()>());
+    static QVector<CategoryComparison> computeCategoryComparison(const LedgerSnapshot& snapshot,
+                                                                 const QDate& startDate, const QDate& endDate);
+    static QVector<SpendingDestination> computeTopDestinations(const LedgerSnapshot& snapshot,
+                                                               const QDate& startDate, const QDate& endDate, int k,
+                                                               int exactKeyLimit = kExactDestinationKeys);
+    static QString normalizeNote(const QString& note);
+    static ChartData computeBudgetChart(const LedgerSnapshot& snapshot, const QVector<Budget>& budgets,
+                                        const QDate& date);
     
+    // 日历区间：周从周一开始，月、年从1日开始
+    static QDate bucketStart(const QDate& date, TimeDimension dimension);
+    static QDate nextBucketStart(const QDate& bucket, TimeDimension dimension);
+    static QString bucketLabel(const QDate& bucket, TimeDimension dimension);
+
 signals:
     void reportGenerated(const StatisticsData& data);
     void chartDataReady(const ChartData& data);
     void reportGenerationFailed(const QString& error);
+    // 记录变更后，已用金额随之变化的进行中预算按当天重新预测
+    void budgetForecastChanged(const ReportService::BudgetForecast& forecast);
 
 private:
+    struct CacheKey {
+        int kind;          // kStatisticsKind 或 ReportType
+        int dimension;
+        qint64 startDay;
+        qint64 endDay;
+        
+        bool operator==(const CacheKey& other) const {
+            return kind == other.kind && dimension == other.dimension
+                && startDay == other.startDay && endDay == other.endDay;
+        }
+        friend size_t qHash(const CacheKey& key, size_t seed = 0) {
+            return qHashMulti(seed, key.kind, key.dimension, key.startDay, key.endDay);
+        }
+    };
+    
+    // 异步请求完成时按请求时的键和数据版本写入缓存
+    struct PendingRequest {
+        CacheKey key = {};
+        quint64 version = 0;
+    };
+    
+    static constexpr int kStatisticsKind = -1;
+    
+    template <typename T, typename Compute>
+    QFuture<T> runAsync(Compute compute);
+    
+    static CacheKey statisticsKey(const QDate& startDate, const QDate& endDate);
+    static CacheKey chartKey(ReportType type, TimeDimension dimension, const QDate& startDate, const QDate& endDate);
+    void validateCache();
+    template <typename T>
+    bool lookupCache(QCache<CacheKey, T>& cache, const CacheKey& key, T& result);
+    template <typename T>
+    void storeInCache(QCache<CacheKey, T>& cache, const PendingRequest& request, const T& result);
+    QVector<Budget> budgetValues() const;
+    ChartData computeChartNow(ReportType type, TimeDimension dimension, const QDate& startDate, const QDate& endDate);
+    
+    // 范围按月份拆分：[firstMonth, lastMonth] 为可直接取自立方体和草图的整月，
+    // partialRanges 为首尾需要读取快照的部分
+    struct MonthSplit {
+        int firstMonth = 0;
+        int lastMonth = -1;
+        QVector<QPair<QDate, QDate>> partialRanges;
+    };
+    
+    static MonthSplit splitByMonth(const LedgerSnapshot& snapshot, const QDate& startDate, const QDate& endDate);
+    
+    // 立方体和金额草图只在GUI线程随数据变更事件维护；草图不支持删除，
+    // 撤销记录时先标记所在的分类 × 月份，事件处理完后从快照重建这些草图
+    void onUserChanged(const User::ChangeEvent& event);
+    void rebuildCube();
+    void applyToCube(const Record& record, int sign);
+    qint64 sketchKey(Record::Type type, int category, int month) const;
+    void refreshStaleSketches();
+    QVector<QuantileSketch> categoryAmountSketches(Record::Type type,
+                                                   const QDate& startDate, const QDate& endDate) const;
+    
+    // 每个预算的预测模型及拟合时子树的先序编号区间；无法增量更新时移除，下次使用时重新拟合
+    struct ForecastState {
+        int firstCategory = -1;
+        int endCategory = -1;
+        SpendingForecast model;
+    };
+    
+    ForecastState& forecastState(const Budget& budget, const QDate& date);
+    void updateForecasts(const User::ChangeEvent& event);
+    QVector<double> cubeCategoryTotals(Record::Type type, const QDate& startDate, const QDate& endDate,
+                                       double& unknownTotal) const;
+    QMap<QString, double> cubeCategoryDistribution(Record::Type type,
+                                                   const QDate& startDate, const QDate& endDate) const;
+    
     std::shared_ptr<User> m_user;
+    int m_subscriptionId;
+    CategoryMonthCube m_cube;
+    QHash<qint64, QuantileSketch> m_amountSketches;
+    QSet<qint64> m_staleSketches;
+    QHash<QString, ForecastState> m_forecasts;     // 预算ID -> 预测状态
+    QThreadPool m_pool;
+    QFutureWatcher<StatisticsData> m_statisticsWatcher;
+    QFutureWatcher<ChartData> m_chartWatcher;
+    PendingRequest m_pendingStatistics;
+    PendingRequest m_pendingChart;
     
-    // 辅助方法
-    QMap<QDate, QVector<std::shared_ptr<Record>>> groupRecordsByDate(
-        const QVector<std::shared_ptr<Record>>& records, TimeDimension dimension);
+    QCache<CacheKey, StatisticsData> m_statisticsCache;
+    QCache<CacheKey, ChartData> m_chartCache;
+    quint64 m_cacheVersion;
+    CacheStats m_cacheStats;
     
-    double calculateAverageDailyExpense(const QDate& startDate, const QDate& endDate);
-    int getDaysInPeriod(const QDate& startDate, const QDate& endDate);
+    static int getDaysInPeriod(const QDate& startDate, const QDate& endDate);
 };
 
 #endif // REPORTSERVICE_H
\ No newline at end of file
@@ -1,7 +1,18 @@
 #include <gtest/gtest.h>
 #include "../models/Record.h"
 #include "../models/Category.h"
+#include "../models/CategoryHierarchy.h"
+#include "../models/StringPool.h"
+#include "../models/ColumnKernels.h"
+#include "../models/CategoryMonthCube.h"
+#include "../models/QuantileSketch.h"
+#include "../models/SpaceSaving.h"
+#include "../models/SpendingForecast.h"
+#include "../models/AmountAnomalyDetector.h"
+#include "../models/DeadlineQueue.h"
 #include <QDateTime>
+#include <thread>
+#include <vector>
 
 // Record类测试
 TEST(RecordTest, Constructor_Default) {
@@ -52,6 +63,26 @@ TEST(RecordTest, SetAndGetDateTime) {
     EXPECT_EQ(record.getDateTime(), dt);
 }
 
+TEST(RecordTest, TimestampAndDay) {
+    Record record;
+    QDateTime dt(QDate(2024, 3, 15), QTime(23, 30));
+    record.setDateTime(dt);
+    EXPECT_EQ(record.getTimestamp(), dt.toMSecsSinceEpoch());
+    EXPECT_EQ(record.getDay(), QDate(2024, 3, 15).toJulianDay());
+    EXPECT_EQ(record.getDate(), QDate(2024, 3, 15));
+
+    record.setTimestamp(dt.addDays(1).toMSecsSinceEpoch());
+    EXPECT_EQ(record.getDate(), QDate(2024, 3, 16));
+}
+
+TEST(RecordTest, Boundary_InvalidDateTime) {
+    Record record;
+    EXPECT_FALSE(record.getDateTime().isValid());
+    record.setDateTime(QDateTime());
+    EXPECT_FALSE(record.getDateTime().isValid());
+    EXPECT_FALSE(record.getDate().isValid());
+}
+
 TEST(RecordTest, SetAndGetNote) {
     Record record;
     QString note = "Test note";
@@ -81,6 +112,45 @@ TEST(RecordTest, MarkAsDeleted) {
     EXPECT_TRUE(record.isDeleted());
 }
 
+TEST(RecordTest, RevisionTracksIndexedFields) {
+    Record record;
+    quint32 revision = record.getRevision();
+    record.setAmount(10.0);
+    record.setType(Record::Type::Income);
+    record.setCategoryId("food");
+    record.setDateTime(QDateTime(QDate(2024, 1, 1), QTime(12, 0)));
+    record.setNote("lunch");
+    EXPECT_EQ(record.getRevision(), revision + 5);
+    // 状态不参与统计，不改变修订号
+    record.markAsDeleted();
+    EXPECT_EQ(record.getRevision(), revision + 5);
+    Record copy = record;
+    EXPECT_EQ(copy.getRevision(), record.getRevision());
+}
+
+TEST(RecordTest, EditCounterCountsEachRecordOnce) {
+    int unreported = 0;
+    Record record;
+    record.setEditCounter(&unreported);
+    record.setAmount(10.0);
+    record.setNote("lunch");
+    EXPECT_EQ(unreported, 1);
+    // 副本不属于账本
+    Record before = record;
+    before.setAmount(20.0);
+    EXPECT_EQ(unreported, 1);
+    record.markEditReported();
+    EXPECT_EQ(unreported, 0);
+    record = before;
+    EXPECT_EQ(unreported, 1);
+    EXPECT_DOUBLE_EQ(record.getAmount(), 20.0);
+    // 断开时结清未登记的修改
+    record.setEditCounter(nullptr);
+    EXPECT_EQ(unreported, 0);
+    record.setAmount(30.0);
+    EXPECT_EQ(unreported, 0);
+}
+
 TEST(RecordTest, GetTypeString) {
     Record record;
     record.setType(Record::Type::Income);
@@ -107,6 +177,29 @@ TEST(RecordTest, Boundary_Amount_Large) {
     EXPECT_EQ(record.getAmount(), 1e10);
 }
 
+TEST(RecordTest, PooledCreate) {
+    auto record = Record::create("pooled_001");
+    EXPECT_EQ(record->getId(), "pooled_001");
+    EXPECT_EQ(record->getStatus(), Record::Status::Draft);
+
+    // 释放的块会被下一次创建复用
+    const Record* address = record.get();
+    record.reset();
+    auto reused = Record::create();
+    EXPECT_EQ(reused.get(), address);
+}
+
+TEST(RecordTest, PooledCreate_Many) {
+    std::vector<std::shared_ptr<Record>> records;
+    for (int i = 0; i < 1000; ++i) {
+        records.push_back(Record::create());
+        records.back()->setAmount(i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(records[i]->getAmount(), i);
+    }
+}
+
 // Category类测试
 TEST(CategoryTest, Constructor_Default) {
     Category category;
@@ -239,6 +332,422 @@ TEST(CategoryTest, Boundary_SortOrder_Large) {
     EXPECT_EQ(category.getSortOrder(), 10000);
 }
 
+// CategoryHierarchy类测试
+static std::shared_ptr<Category> makeCategory(const QString& id, const QString& name,
+                                              const QString& parentId = QString()) {
+    auto category = std::make_shared<Category>(id);
+    category->setName(name);
+    category->setParentId(parentId);
+    return category;
+}
+
+TEST(CategoryHierarchyTest, SubtreeContainment) {
+    CategoryHierarchy hierarchy;
+    hierarchy.rebuild({makeCategory("food", "Food"),
+                       makeCategory("lunch", "Lunch", "food"),
+                       makeCategory("snack", "Snack", "lunch"),
+                       makeCategory("transport", "Transport")});
+
+    EXPECT_EQ(hierarchy.size(), 4);
+    EXPECT_TRUE(hierarchy.contains("food", "snack"));
+    EXPECT_TRUE(hierarchy.contains("lunch", "lunch"));
+    EXPECT_FALSE(hierarchy.contains("lunch", "food"));
+    EXPECT_FALSE(hierarchy.contains("transport", "lunch"));
+    EXPECT_EQ(hierarchy.displayPath("snack"), "Food > Lunch > Snack");
+    EXPECT_EQ(hierarchy.idAt(hierarchy.parentOf(hierarchy.indexOf("lunch"))), "food");
+    EXPECT_EQ(hierarchy.subtreeIds("food"), QVector<QString>({"food", "lunch", "snack"}));
+    EXPECT_EQ(hierarchy.subtreeIds("unknown"), QVector<QString>({"unknown"}));
+}
+
+TEST(CategoryHierarchyTest, Rollup) {
+    CategoryHierarchy hierarchy;
+    hierarchy.rebuild({makeCategory("food", "Food"),
+                       makeCategory("lunch", "Lunch", "food"),
+                       makeCategory("dinner", "Dinner", "food"),
+                       makeCategory("transport", "Transport")});
+
+    QVector<double> totals(hierarchy.size(), 0.0);
+    totals[hierarchy.indexOf("food")] = 5.0;
+    totals[hierarchy.indexOf("lunch")] = 10.0;
+    totals[hierarchy.indexOf("dinner")] = 20.0;
+    totals[hierarchy.indexOf("transport")] = 7.0;
+
+    QVector<double> rolled = hierarchy.rollup(totals);
+    EXPECT_DOUBLE_EQ(rolled[hierarchy.indexOf("food")], 35.0);
+    EXPECT_DOUBLE_EQ(rolled[hierarchy.indexOf("lunch")], 10.0);
+    EXPECT_DOUBLE_EQ(rolled[hierarchy.indexOf("transport")], 7.0);
+}
+
+TEST(CategoryHierarchyTest, Boundary_Cycle) {
+    CategoryHierarchy hierarchy;
+    hierarchy.rebuild({makeCategory("a", "A", "b"),
+                       makeCategory("b", "B", "a")});
+
+    EXPECT_EQ(hierarchy.size(), 2);
+    EXPECT_GE(hierarchy.indexOf("a"), 0);
+    EXPECT_GE(hierarchy.indexOf("b"), 0);
+}
+
+// StringPool类测试
+TEST(StringPoolTest, InternDeduplicates) {
+    StringPool pool;
+    int lunch = pool.intern("lunch");
+    int rent = pool.intern("rent");
+    EXPECT_NE(lunch, rent);
+    EXPECT_EQ(pool.intern(QString("lun") + "ch"), lunch);
+    EXPECT_EQ(pool.at(lunch), "lunch");
+    EXPECT_EQ(pool.find("rent"), rent);
+    EXPECT_EQ(pool.find("coffee"), -1);
+    EXPECT_EQ(pool.size(), 3);
+}
+
+TEST(StringPoolTest, Boundary_EmptyAndInvalid) {
+    StringPool pool;
+    EXPECT_EQ(pool.intern(QString()), 0);
+    EXPECT_EQ(pool.intern(""), 0);
+    EXPECT_TRUE(pool.at(0).isEmpty());
+    EXPECT_TRUE(pool.at(-1).isEmpty());
+    EXPECT_TRUE(pool.at(100).isEmpty());
+}
+
+TEST(StringPoolTest, Boundary_ManyChunks) {
+    StringPool pool;
+    for (int i = 0; i < 3000; ++i) {
+        pool.intern(QString::number(i));
+    }
+    EXPECT_EQ(pool.at(pool.find("2999")), "2999");
+    EXPECT_EQ(pool.size(), 3001);
+}
+
+TEST(StringPoolTest, ConcurrentReadsDuringIntern) {
+    StringPool pool;
+    const int count = 5000;
+    std::thread writer([&pool] {
+        for (int i = 1; i <= count; ++i) {
+            pool.intern(QString::number(i));
+        }
+    });
+    // 编号按插入顺序分配，已发布的编号 id 对应字符串 QString::number(id)
+    int mismatches = 0;
+    int checked = 1;
+    while (checked < count + 1) {
+        int published = pool.size();
+        for (; checked < published; ++checked) {
+            if (pool.at(checked) != QString::number(checked)) {
+                ++mismatches;
+            }
+        }
+    }
+    writer.join();
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(pool.size(), count + 1);
+}
+
+TEST(RecordTest, SharedNoteId) {
+    Record first;
+    Record second;
+    first.setNote("coffee");
+    second.setNote("coffee");
+    EXPECT_EQ(first.getNoteId(), second.getNoteId());
+    EXPECT_EQ(second.getNote(), "coffee");
+}
+
+// ColumnKernels测试
+TEST(ColumnKernelsTest, SumWhereKind) {
+    std::vector<double> amounts;
+    std::vector<quint8> kinds;
+    double expected = 0.0;
+    for (int i = 0; i < 1003; ++i) {
+        amounts.push_back(i * 0.25);
+        kinds.push_back(static_cast<quint8>(i % 3 == 0 ? Record::Type::Income : Record::Type::Expense));
+        if (i % 3 == 0) {
+            expected += i * 0.25;
+        }
+    }
+    const quint8 income = static_cast<quint8>(Record::Type::Income);
+    EXPECT_DOUBLE_EQ(ColumnKernels::sumWhereKind(amounts.data(), kinds.data(), 1003, income), expected);
+    // 各种尾部长度下向量实现与标量实现逐位一致
+    for (int count = 0; count <= 20; ++count) {
+        EXPECT_EQ(ColumnKernels::sumWhereKind(amounts.data() + 1, kinds.data() + 1, count, income),
+                  ColumnKernels::sumWhereKindScalar(amounts.data() + 1, kinds.data() + 1, count, income));
+    }
+}
+
+TEST(ColumnKernelsTest, Boundary_EmptyAndNoMatch) {
+    double amounts[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    quint8 kinds[9] = {};
+    EXPECT_EQ(ColumnKernels::sumWhereKind(amounts, kinds, 0, 0), 0.0);
+    EXPECT_EQ(ColumnKernels::sumWhereKind(amounts, kinds, 9, 1), 0.0);
+    EXPECT_EQ(ColumnKernels::sumWhereKind(amounts, kinds, 9, 0), 45.0);
+}
+
+// CategoryMonthCube测试
+TEST(CategoryMonthCubeTest, AddAndSlice) {
+    CategoryMonthCube cube(3);
+    int january = CategoryMonthCube::monthOf(QDate(2024, 1, 15));
+    EXPECT_EQ(CategoryMonthCube::monthStart(january), QDate(2024, 1, 1));
+    cube.add(Record::Type::Expense, 0, january, 10.0, 1);
+    cube.add(Record::Type::Expense, 2, january + 1, 5.0, 1);
+    cube.add(Record::Type::Expense, -1, january + 1, 7.0, 1);
+    cube.add(Record::Type::Income, 1, january - 30, 100.0, 1);
+
+    auto totals = cube.categoryTotals(Record::Type::Expense, january, january + 1);
+    ASSERT_EQ(totals.size(), 4);
+    EXPECT_DOUBLE_EQ(totals[0].amount, 10.0);
+    EXPECT_DOUBLE_EQ(totals[2].amount, 5.0);
+    EXPECT_DOUBLE_EQ(totals[cube.unknownCategory()].amount, 7.0);
+    EXPECT_EQ(totals[1].count, 0);
+    EXPECT_DOUBLE_EQ(cube.cell(Record::Type::Income, 1, january - 30).amount, 100.0);
+
+    auto series = cube.monthSeries(Record::Type::Expense, 0, 3, january - 1, january + 1);
+    ASSERT_EQ(series.size(), 3);
+    EXPECT_EQ(series[0].count, 0);
+    EXPECT_DOUBLE_EQ(series[1].amount, 10.0);
+    EXPECT_DOUBLE_EQ(series[2].amount, 5.0);
+}
+
+TEST(CategoryMonthCubeTest, Boundary_UndoAndOutOfRange) {
+    CategoryMonthCube cube(1);
+    EXPECT_TRUE(cube.isEmpty());
+    EXPECT_EQ(cube.categoryTotals(Record::Type::Expense, 0, 100000)[0].count, 0);
+    int month = CategoryMonthCube::monthOf(QDate(2024, 6, 1));
+    cube.add(Record::Type::Expense, 0, month, 0.1, 1);
+    cube.add(Record::Type::Expense, 0, month, 0.2, 1);
+    cube.add(Record::Type::Expense, 0, month, -0.1, -1);
+    cube.add(Record::Type::Expense, 0, month, -0.2, -1);
+    // 全部撤销后金额精确归零
+    EXPECT_EQ(cube.cell(Record::Type::Expense, 0, month).amount, 0.0);
+    EXPECT_EQ(cube.cell(Record::Type::Expense, 0, month + 500).count, 0);
+}
+
+TEST(QuantileSketchTest, ExactForSmallInput) {
+    QuantileSketch sketch;
+    EXPECT_TRUE(sketch.isEmpty());
+    EXPECT_EQ(sketch.quantile(0.5), 0.0);
+    for (int i = 100; i >= 1; --i) {
+        sketch.insert(i);
+    }
+    EXPECT_EQ(sketch.count(), 100u);
+    EXPECT_EQ(sketch.quantile(0.5), 50.0);
+    EXPECT_EQ(sketch.quantile(0.9), 90.0);
+    EXPECT_EQ(sketch.quantile(0.99), 99.0);
+    EXPECT_EQ(sketch.quantile(0.0), 1.0);
+    EXPECT_EQ(sketch.quantile(1.0), 100.0);
+}
+
+TEST(QuantileSketchTest, BoundedRankErrorAndMerge) {
+    // 0..n-1 的一个固定排列，分成两半分别插入后合并
+    const int n = 100000;
+    QuantileSketch whole;
+    QuantileSketch first;
+    QuantileSketch second;
+    for (int i = 0; i < n; ++i) {
+        double value = (i * 7919) % n;
+        whole.insert(value);
+        (i < n / 2 ? first : second).insert(value);
+    }
+    first.merge(second);
+    EXPECT_EQ(first.count(), quint64(n));
+    EXPECT_LT(whole.retainedCount(), 3 * QuantileSketch::kDefaultK + 64);
+    EXPECT_EQ(first.min(), 0.0);
+    EXPECT_EQ(first.max(), n - 1.0);
+    for (double q : {0.1, 0.5, 0.9, 0.99}) {
+        // 值即秩，秩误差不超过 2%
+        EXPECT_NEAR(whole.quantile(q), q * n, 0.02 * n);
+        EXPECT_NEAR(first.quantile(q), q * n, 0.02 * n);
+    }
+}
+
+TEST(SpaceSavingTest, ExactWithinCapacity) {
+    SpaceSaving counters(4);
+    counters.add(1, 5.0, 7);
+    counters.add(2, 1.0);
+    counters.add(1, 2.5, 8);
+    counters.add(3, 4.0);
+    auto top = counters.top(2);
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].key, 1u);
+    EXPECT_DOUBLE_EQ(top[0].count, 7.5);
+    EXPECT_DOUBLE_EQ(top[0].error, 0.0);
+    // label 保留键第一次出现时的值
+    EXPECT_EQ(top[0].label, 7);
+    EXPECT_EQ(top[1].key, 3u);
+    EXPECT_EQ(counters.top(10).size(), 3);
+    EXPECT_DOUBLE_EQ(counters.total(), 12.5);
+}
+
+TEST(SpaceSavingTest, Boundary_HeavyHittersSurviveEviction) {
+    // 3 个大额键与 1000 个小额键交错出现，计数器只有 20 个
+    SpaceSaving counters(20);
+    QVector<double> truth(1003, 0.0);
+    for (int i = 0; i < 10000; ++i) {
+        int key = i % 4 == 0 ? (i / 4) % 3 : 3 + i % 1000;
+        double weight = key < 3 ? 10.0 : 1.0;
+        counters.add(key, weight);
+        truth[key] += weight;
+    }
+    EXPECT_EQ(counters.size(), 20);
+    auto top = counters.top(3);
+    ASSERT_EQ(top.size(), 3);
+    for (const auto& counter : top) {
+        EXPECT_LT(counter.key, 3u);
+        // 真实值在 [count - error, count] 内
+        EXPECT_GE(counter.count, truth[counter.key]);
+        EXPECT_LE(counter.count - counter.error, truth[counter.key]);
+        EXPECT_LE(counter.error, counters.total() / counters.capacity());
+    }
+}
+
+TEST(SpendingForecastTest, ConstantAndWeekdaySeasonality) {
+    SpendingForecast constant;
+    QDate monday(2024, 1, 1);
+    for (int day = 0; day < 30; ++day) {
+        EXPECT_TRUE(constant.add(monday.addDays(day), 10.0));
+    }
+    EXPECT_EQ(constant.currentDay(), monday.addDays(29));
+    EXPECT_EQ(constant.foldedDays(), 29);
+    EXPECT_NEAR(constant.dailyForecast(monday.addDays(30)), 10.0, 1e-9);
+    EXPECT_NEAR(constant.projectRange(monday.addDays(30), monday.addDays(39)), 100.0, 1e-9);
+
+    // 每周一支出70元，其余日子没有支出
+    SpendingForecast weekly;
+    for (int day = 0; day < 84; ++day) {
+        weekly.add(monday.addDays(day), day % 7 == 0 ? 70.0 : 0.0);
+    }
+    QDate nextMonday = monday.addDays(84);
+    EXPECT_GT(weekly.dailyForecast(nextMonday), 3 * weekly.dailyForecast(nextMonday.addDays(1)));
+    EXPECT_NEAR(weekly.projectRange(nextMonday, nextMonday.addDays(6)), 70.0, 15.0);
+}
+
+TEST(SpendingForecastTest, Boundary_EmptyAndOutOfOrder) {
+    SpendingForecast forecast;
+    EXPECT_FALSE(forecast.isValid());
+    EXPECT_EQ(forecast.dailyForecast(QDate(2024, 1, 1)), 0.0);
+    EXPECT_TRUE(forecast.add(QDate(2024, 1, 10), 5.0));
+    EXPECT_TRUE(forecast.add(QDate(2024, 1, 10), 5.0));
+    EXPECT_EQ(forecast.currentDayAmount(), 10.0);
+    // 已折入状态的日子不能再加入
+    EXPECT_TRUE(forecast.add(QDate(2024, 1, 12), 1.0));
+    EXPECT_FALSE(forecast.add(QDate(2024, 1, 11), 1.0));
+    EXPECT_EQ(forecast.foldedDays(), 2);
+}
+
+TEST(AmountAnomalyDetectorTest, FlagsLargeAmountsAfterWarmup) {
+    AmountAnomalyDetector detector;
+    const QString food = "food";
+    // 预热阶段不判断异常
+    for (int i = 0; i < AmountAnomalyDetector::kWarmupCount; ++i) {
+        EXPECT_FALSE(detector.observe(Record::Type::Expense, food, i == 3 ? 500.0 : 20.0 + i % 5).anomalous);
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(detector.observe(Record::Type::Expense, food, 20.0 + i % 5).anomalous);
+    }
+    auto result = detector.observe(Record::Type::Expense, food, 300.0);
+    EXPECT_TRUE(result.anomalous);
+    EXPECT_GT(result.score, detector.threshold());
+    EXPECT_NEAR(result.typicalAmount, 22.0, 1.5);
+    // 一次异常值不会明显改变画像
+    EXPECT_NEAR(detector.evaluate(Record::Type::Expense, food, 22.0).typicalAmount, 22.0, 1.5);
+    EXPECT_FALSE(detector.observe(Record::Type::Expense, food, 24.0).anomalous);
+
+    const auto& profile = detector.profiles().value(AmountAnomalyDetector::keyFor(Record::Type::Expense, food));
+    EXPECT_EQ(profile.count, quint64(AmountAnomalyDetector::kWarmupCount + 102));
+    EXPECT_TRUE(profile.warmup.isEmpty());
+}
+
+TEST(AmountAnomalyDetectorTest, Boundary_SeparateKeysAndConstantAmounts) {
+    AmountAnomalyDetector detector;
+    for (int i = 0; i < 30; ++i) {
+        detector.observe(Record::Type::Expense, "rent", 1000.0);
+    }
+    // 金额固定的分类允许小幅变化，收入与支出分别统计
+    EXPECT_FALSE(detector.evaluate(Record::Type::Expense, "rent", 1050.0).anomalous);
+    EXPECT_TRUE(detector.evaluate(Record::Type::Expense, "rent", 2000.0).anomalous);
+    EXPECT_FALSE(detector.evaluate(Record::Type::Income, "rent", 2000.0).anomalous);
+    EXPECT_FALSE(detector.evaluate(Record::Type::Expense, "other", 1e9).anomalous);
+}
+
+TEST(AmountAnomalyDetectorTest, Boundary_ForgetRevertsObservations) {
+    AmountAnomalyDetector detector;
+    AmountAnomalyDetector expected;
+    const QString food = "food";
+    const auto key = AmountAnomalyDetector::keyFor(Record::Type::Expense, food);
+    // 预热阶段精确撤销
+    for (double amount : {20.0, 22.0, 5000.0, 24.0}) {
+        detector.observe(Record::Type::Expense, food, amount);
+        if (amount != 5000.0) {
+            expected.observe(Record::Type::Expense, food, amount);
+        }
+    }
+    detector.forget(Record::Type::Expense, food, 5000.0);
+    detector.forget(Record::Type::Expense, food, 99.0);
+    detector.forget(Record::Type::Income, food, 20.0);
+    auto profile = detector.profiles().value(key);
+    auto expectedProfile = expected.profiles().value(key);
+    EXPECT_EQ(profile.count, expectedProfile.count);
+    EXPECT_DOUBLE_EQ(profile.mean, expectedProfile.mean);
+    EXPECT_NEAR(profile.m2, expectedProfile.m2, 1e-6);
+    EXPECT_DOUBLE_EQ(profile.median, expectedProfile.median);
+    EXPECT_EQ(profile.warmup, expectedProfile.warmup);
+    for (double amount : {20.0, 22.0, 24.0}) {
+        detector.forget(Record::Type::Expense, food, amount);
+    }
+    EXPECT_EQ(detector.profiles().value(key).count, quint64(0));
+
+    // 预热完成后撤销均值和方差，笔数不回到预热阶段
+    const int total = AmountAnomalyDetector::kWarmupCount + 2;
+    for (int i = 0; i < total; ++i) {
+        detector.observe(Record::Type::Expense, food, 20.0 + i % 5);
+    }
+    double mean = detector.profiles().value(key).mean;
+    detector.observe(Record::Type::Expense, food, 400.0);
+    detector.forget(Record::Type::Expense, food, 400.0);
+    EXPECT_NEAR(detector.profiles().value(key).mean, mean, 1e-9);
+    for (int i = 0; i < 5; ++i) {
+        detector.forget(Record::Type::Expense, food, 20.0);
+    }
+    EXPECT_EQ(detector.profiles().value(key).count, quint64(AmountAnomalyDetector::kWarmupCount));
+    EXPECT_TRUE(detector.evaluate(Record::Type::Expense, food, 400.0).anomalous);
+}
+
+TEST(DeadlineQueueTest, PopsInDeadlineOrder) {
+    DeadlineQueue queue;
+    queue.schedule("c", 30);
+    queue.schedule("a", 10);
+    queue.schedule("b", 20);
+    queue.schedule("d", 40);
+    EXPECT_EQ(queue.next().id, QString("a"));
+    
+    // 改期与取消
+    queue.schedule("a", 35);
+    EXPECT_TRUE(queue.cancel("b"));
+    EXPECT_FALSE(queue.cancel("b"));
+    EXPECT_EQ(queue.size(), 3);
+    
+    auto due = queue.popDue(35);
+    ASSERT_EQ(due.size(), 2);
+    EXPECT_EQ(due[0].id, QString("c"));
+    EXPECT_EQ(due[1].id, QString("a"));
+    EXPECT_EQ(queue.next().id, QString("d"));
+    EXPECT_TRUE(queue.popDue(39).isEmpty());
+}
+
+TEST(DeadlineQueueTest, Boundary_ManyEntriesWithCancellation) {
+    DeadlineQueue queue;
+    for (int i = 0; i < 5000; ++i) {
+        queue.schedule(QString::number(i), (i * 7919) % 5000);
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        queue.cancel(QString::number(i));
+    }
+    auto due = queue.popDue(5000);
+    EXPECT_EQ(due.size(), 5000 - 1667);
+    for (int i = 1; i < due.size(); ++i) {
+        EXPECT_LE(due[i - 1].deadline, due[i].deadline);
+    }
+    EXPECT_TRUE(queue.isEmpty());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -16,14 +16,63 @@ BudgetWidget::BudgetWidget(std::shared_ptr<User> user, QWidget *parent)
     , m_user(user)
     , m_model(nullptr)
     , m_selectedBudget(nullptr)
+    , m_subscriptionId(-1)
 {
     setupUI();
     createConnections();
     loadCategories();
     loadBudgets();
+
+    if (m_user) {
+        m_subscriptionId = m_user->subscribe([this](const User::ChangeEvent& event) {
+            onUserChanged(event);
+        });
+    }
 }
 
 BudgetWidget::~BudgetWidget() {
+    if (m_user) {
+        m_user->unsubscribe(m_subscriptionId);
+    }
+}
+
+void BudgetWidget::onUserChanged(const User::ChangeEvent& event) {
+    using Kind = User::ChangeEvent::Kind;
+
+    if (event.isRecordEvent()) {
+        // 只刷新已用金额发生变化的预算行
+        if (event.affectedBudgets.isEmpty()) return;
+        for (const auto& budget : event.affectedBudgets) {
+            m_model->updateBudget(budget);
+        }
+        updateBudgetProgress();
+        return;
+    }
+
+    switch (event.kind) {
+        case Kind::BudgetAdded:
+            m_model->addBudget(event.budget);
+            break;
+        case Kind::BudgetModified:
+            m_model->updateBudget(event.budget);
+            break;
+        case Kind::BudgetRemoved:
+            m_model->removeBudget(event.budget->getId());
+            if (m_selectedBudget == event.budget) {
+                m_selectedBudget = nullptr;
+            }
+            break;
+        case Kind::CategoryAdded:
+        case Kind::CategoryModified:
+        case Kind::CategoryRemoved:
+            // 分类层级变化会重新计算所有预算
+            loadCategories();
+            loadBudgets();
+            break;
+        default:
+            return;
+    }
+    updateBudgetProgress();
 }
 
 void BudgetWidget::setupUI() {
@@ -69,6 +118,7 @@ void BudgetWidget::setupUI() {
     m_alertSlider->setValue(80);
     
     m_periodCombo->addItem("月度", "monthly");
+    m_periodCombo->addItem("周度", "weekly");
     m_periodCombo->addItem("年度", "yearly");
     
     settingsLayout->addWidget(new QLabel("分类:", this));
@@ -124,9 +174,10 @@ void BudgetWidget::createConnections() {
 void BudgetWidget::loadCategories() {
     m_categoryCombo->clear();
     if (!m_user) return;
-    auto cats = m_user->getTopLevelCategories();
-    for (const auto& c : cats) {
-        m_categoryCombo->addItem(c->getName(), c->getId());
+    for (const auto& c : m_user->getAllCategories()) {
+        if (c->isTopLevel()) {
+            m_categoryCombo->addItem(c->getName(), c->getId());
+        }
     }
 }
 
@@ -152,8 +203,7 @@ void BudgetWidget::refreshData() {
 
 void BudgetWidget::loadBudgets() {
     if (!m_user) return;
-    auto budgets = m_user->getAllBudgets();
-    m_model->setBudgets(budgets);
+    m_model->setBudgets(m_user->getAllBudgets());
     updateBudgetProgress();
     checkBudgetAlerts();
 }
@@ -177,25 +227,25 @@ void BudgetWidget::onAddBudget() {
         m_selectedBudget->setAlertPercent(m_alertSlider->value() / 100.0);
         QString period = m_periodCombo->currentData().toString();
         if (period == "monthly") m_selectedBudget->setPeriod(Budget::Period::Monthly);
+        else if (period == "weekly") m_selectedBudget->setPeriod(Budget::Period::Weekly);
         else if (period == "yearly") m_selectedBudget->setPeriod(Budget::Period::Yearly);
         m_selectedBudget->resetForNewPeriod();
-        m_model->updateBudget(m_selectedBudget);
+        m_user->updateBudget(m_selectedBudget);
     } else {
-        auto budget = std::make_shared<Budget>();
+        auto budget = Budget::create();
         budget->setCategoryId(categoryId);
         budget->setTotalAmount(amount);
         budget->setAlertPercent(m_alertSlider->value() / 100.0);
         QString period = m_periodCombo->currentData().toString();
         if (period == "monthly") budget->setPeriod(Budget::Period::Monthly);
+        else if (period == "weekly") budget->setPeriod(Budget::Period::Weekly);
         else if (period == "yearly") budget->setPeriod(Budget::Period::Yearly);
         budget->resetForNewPeriod();
 
         m_user->addBudget(budget);
-        m_model->addBudget(budget);
     }
 
-    // refresh display
-    loadBudgets();
+    // 模型已通过变更事件更新
     updateBudgetProgress();
     checkBudgetAlerts();
 }
@@ -218,7 +268,9 @@ void BudgetWidget::onEditBudget() {
     m_amountSpinBox->setValue(m_selectedBudget->getTotalAmount());
     m_alertSlider->setValue(static_cast<int>(m_selectedBudget->getAlertPercent() * 100));
     // period
-    QString p = (m_selectedBudget->getPeriod() == Budget::Period::Yearly) ? "yearly" : "monthly";
+    QString p = "monthly";
+    if (m_selectedBudget->getPeriod() == Budget::Period::Yearly) p = "yearly";
+    else if (m_selectedBudget->getPeriod() == Budget::Period::Weekly) p = "weekly";
     for (int i = 0; i < m_periodCombo->count(); ++i) {
         if (m_periodCombo->itemData(i).toString() == p) {
             m_periodCombo->setCurrentIndex(i);
@@ -233,11 +285,8 @@ void BudgetWidget::onDeleteBudget() {
     auto b = m_model->getBudget(idx.row());
     if (!b) return;
     m_user->removeBudget(b->getId());
-    m_model->removeBudget(b->getId());
     m_selectedBudget = nullptr;
-    loadBudgets();
     updateBudgetProgress();
-    checkBudgetAlerts();
 }
 
 void BudgetWidget::onBudgetSelected(const QModelIndex& index) {
@@ -290,7 +339,8 @@ void BudgetWidget::updateBudgetProgress() {
 void BudgetWidget::checkBudgetAlerts() {
     if (!m_user) return;
 
-    auto budgets = m_user->getAllBudgets();
+    // 发出的信号可能触发预算变更，遍历隐式共享的副本
+    const auto budgets = m_user->getAllBudgets();
     for (const auto& b : budgets) {
         if (!b) continue;
         b->checkAndUpdateStatus();
@@ -56,6 +56,7 @@ private:
     void loadCategories();
     void updateBudgetDisplay();
     void showBudgetAlert(std::shared_ptr<Budget> budget);
+    void onUserChanged(const User::ChangeEvent& event);
     
     // UI组件
     QTableView* m_budgetView;
@@ -84,6 +85,7 @@ private:
     // 数据
     std::shared_ptr<User> m_user;
     std::shared_ptr<Budget> m_selectedBudget;
+    int m_subscriptionId;
 };
 
 // 预算数据模型
@@ -12,19 +12,23 @@
 #include <QChart>
 #include <QPieSeries>
 #include <QBarSeries>
+#include <QBarSet>
 #include <QLineSeries>
 #include <QValueAxis>
 #include <QBarCategoryAxis>
 
-StatisticsWidget::StatisticsWidget(std::shared_ptr<User> user, QWidget *parent)
+StatisticsWidget::StatisticsWidget(std::shared_ptr<User> user, std::shared_ptr<ReportService> reportService,
+                                   QWidget *parent)
     : QWidget(parent)
     , m_user(user)
+    , m_reportService(reportService)
 {
     setupUI();
     createConnections();
     
-    // 创建报告服务
-    m_reportService = std::make_shared<ReportService>(m_user);
+    if (!m_reportService) {
+        m_reportService = std::make_shared<ReportService>(m_user);
+    }
     connect(m_reportService.get(), &ReportService::reportGenerated, 
             this, &StatisticsWidget::onReportGenerated);
     connect(m_reportService.get(), &ReportService::chartDataReady, 
@@ -60,9 +64,14 @@ void StatisticsWidget::setupUI() {
     
     // 图表类型选择
     m_chartTypeCombo = new QComboBox();
-    m_chartTypeCombo->addItems({"收支分析", "分类统计", "趋势分析", "预算执行"});
+    m_chartTypeCombo->addItems({"收支分析", "分类统计", "趋势分析", "预算执行", "滚动支出", "同比环比", "支出去向"});
     controlLayout->addRow("图表类型:", m_chartTypeCombo);
     
+    // 趋势图的统计粒度
+    m_timeDimensionCombo = new QComboBox();
+    m_timeDimensionCombo->addItems({"按日", "按周", "按月", "按年"});
+    controlLayout->addRow("统计粒度:", m_timeDimensionCombo);
+    
     // 操作按钮
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     m_generateButton = new QPushButton("生成报告");
@@ -120,6 +129,8 @@ void StatisticsWidget::createConnections() {
             this, &StatisticsWidget::onEndDateChanged);
     connect(m_chartTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &StatisticsWidget::onChartTypeChanged);
+    connect(m_timeDimensionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &StatisticsWidget::onTimeDimensionChanged);
     connect(m_generateButton, &QPushButton::clicked,
             this, &StatisticsWidget::onGenerateReport);
     connect(m_exportButton, &QPushButton::clicked,
@@ -128,57 +139,63 @@ void StatisticsWidget::createConnections() {
 
 void StatisticsWidget::refreshData() {
     updateCharts();
-    updateSummaryLabels();
+    requestStatistics();
 }
 
 void StatisticsWidget::updateCharts() {
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
-    
+    requestChart();
+}
+
+void StatisticsWidget::requestStatistics() {
+    m_reportService->generateStatisticsAsync(m_startDateEdit->date(), m_endDateEdit->date());
+}
+
+void StatisticsWidget::requestChart() {
     // 根据选择的图表类型生成不同的图表
     int chartType = m_chartTypeCombo->currentIndex();
-    
+    ReportService::ReportType type = ReportService::ReportType::IncomeExpense;
     switch (chartType) {
-        case 0: // 收支分析
-            updateIncomeExpenseChart();
-            break;
         case 1: // 分类统计
-            updateCategoryChart();
+            type = ReportService::ReportType::CategoryAnalysis;
             break;
         case 2: // 趋势分析
-            updateTrendChart();
+            type = ReportService::ReportType::TrendAnalysis;
+            break;
+        case 3: // 预算执行（以结束日期所在周期为当前周期）
+            type = ReportService::ReportType::BudgetPerformance;
+            break;
+        case 4: // 滚动支出
+            type = ReportService::ReportType::RollingSpend;
+            break;
+        case 5: // 同比环比（与上月同期、去年同期比较）
+            type = ReportService::ReportType::PeriodComparison;
+            break;
+        case 6: // 支出去向
+            type = ReportService::ReportType::TopDestinations;
+            break;
+        default: // 收支分析
             break;
-        default:
-            updateIncomeExpenseChart();
     }
+    
+    // 下拉框顺序与 TimeDimension 的枚举顺序一致
+    auto dimension = static_cast<ReportService::TimeDimension>(m_timeDimensionCombo->currentIndex());
+    m_reportService->generateChartDataAsync(type, dimension, m_startDateEdit->date(), m_endDateEdit->date());
 }
 
-void StatisticsWidget::updateIncomeExpenseChart() {
+void StatisticsWidget::updateIncomeExpenseChart(const ReportService::ChartData& data) {
     QChart* chart = new QChart();
     chart->setTitle("收支分析");
     
     QPieSeries* series = new QPieSeries();
     
-    // 获取数据并添加到图表
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
-    
-    double totalIncome = m_user->getTotalIncome(startDate, endDate);
-    double totalExpense = m_user->getTotalExpense(startDate, endDate);
-    
-    if (totalIncome > 0) {
-        series->append("收入", totalIncome);
-    }
-    if (totalExpense > 0) {
-        series->append("支出", totalExpense);
-    }
-    
-    // 设置颜色
-    if (series->count() > 0) {
-        series->slices().at(0)->setColor(QColor("#27AE60")); // 绿色 - 收入
-    }
-    if (series->count() > 1) {
-        series->slices().at(1)->setColor(QColor("#E74C3C")); // 红色 - 支出
+    // 收入为绿色，支出为红色
+    for (int i = 0; i < data.values.size(); ++i) {
+        if (data.values[i] > 0) {
+            auto slice = series->append(data.labels.value(i), data.values[i]);
+            if (i < data.colors.size()) {
+                slice->setColor(data.colors[i]);
+            }
+        }
     }
     
     chart->addSeries(series);
@@ -187,18 +204,12 @@ void StatisticsWidget::updateIncomeExpenseChart() {
     m_mainChartView->setChart(chart);
 }
 
-void StatisticsWidget::updateCategoryChart() {
+void StatisticsWidget::updateCategoryChart(const ReportService::ChartData& data) {
     QChart* chart = new QChart();
     chart->setTitle("分类支出统计");
     
     QPieSeries* series = new QPieSeries();
     
-    // 获取分类支出数据
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
-    
-    auto categoryExpenses = m_reportService->getCategoryExpenseDistribution(startDate, endDate);
-    
     QVector<QColor> colors = {
         QColor("#FF6B35"), QColor("#4A90E2"), QColor("#9013FE"), 
         QColor("#27AE60"), QColor("#F5A623"), QColor("#D0021B"),
@@ -206,9 +217,9 @@ void StatisticsWidget::updateCategoryChart() {
     };
     
     int colorIndex = 0;
-    for (auto it = categoryExpenses.begin(); it != categoryExpenses.end(); ++it) {
-        if (it.value() > 0) {
-            auto slice = series->append(it.key(), it.value());
+    for (int i = 0; i < data.values.size(); ++i) {
+        if (data.values[i] > 0) {
+            auto slice = series->append(data.labels.value(i), data.values[i]);
             slice->setColor(colors[colorIndex % colors.size()]);
             colorIndex++;
         }
@@ -220,7 +231,7 @@ void StatisticsWidget::updateCategoryChart() {
     m_mainChartView->setChart(chart);
 }
 
-void StatisticsWidget::updateTrendChart() {
+void StatisticsWidget::updateTrendChart(const ReportService::ChartData& data) {
     QChart* chart = new QChart();
     chart->setTitle("收支趋势分析");
     
@@ -233,28 +244,33 @@ void StatisticsWidget::updateTrendChart() {
     expenseSeries->setName("支出");
     expenseSeries->setColor(QColor("#E74C3C"));
     
-    // 获取趋势数据
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
-    
-    auto incomeTrend = m_reportService->getIncomeTrend(startDate, endDate);
-    auto expenseTrend = m_reportService->getExpenseTrend(startDate, endDate);
-    
-    // 添加数据点
-    for (auto it = incomeTrend.begin(); it != incomeTrend.end(); ++it) {
-        incomeSeries->append(it.key().toJulianDay(), it.value());
-    }
-    
-    for (auto it = expenseTrend.begin(); it != expenseTrend.end(); ++it) {
-        expenseSeries->append(it.key().toJulianDay(), it.value());
+    // 每个日历区间一个数据点，横轴按区间顺序排列
+    QStringList categories;
+    for (int i = 0; i < data.keys.size(); ++i) {
+        incomeSeries->append(i, data.incomeValues.value(i));
+        expenseSeries->append(i, data.values.value(i));
+        categories.append(data.labels.value(i));
     }
     
     chart->addSeries(incomeSeries);
     chart->addSeries(expenseSeries);
     
     // 设置坐标轴
-    QValueAxis* axisX = new QValueAxis();
-    axisX->setTitleText("日期");
+    QBarCategoryAxis* axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    switch (data.dimension) {
+        case ReportService::TimeDimension::Weekly:
+            axisX->setTitleText("周");
+            break;
+        case ReportService::TimeDimension::Monthly:
+            axisX->setTitleText("月份");
+            break;
+        case ReportService::TimeDimension::Yearly:
+            axisX->setTitleText("年份");
+            break;
+        default:
+            axisX->setTitleText("日期");
+    }
     chart->addAxis(axisX, Qt::AlignBottom);
     
     QValueAxis* axisY = new QValueAxis();
@@ -271,16 +287,159 @@ void StatisticsWidget::updateTrendChart() {
     m_mainChartView->setChart(chart);
 }
 
-void StatisticsWidget::updateSummaryLabels() {
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
+void StatisticsWidget::updateBudgetChart(const ReportService::ChartData& data) {
+    QChart* chart = new QChart();
+    chart->setTitle("预算执行情况");
+    
+    // 每个预算一组柱：预算金额与实际支出
+    QBarSet* budgetSet = new QBarSet("预算");
+    budgetSet->setColor(QColor("#3498DB"));
+    QBarSet* actualSet = new QBarSet("实际");
+    actualSet->setColor(QColor("#E74C3C"));
+    QStringList categories;
+    for (int i = 0; i < data.labels.size(); ++i) {
+        budgetSet->append(data.budgetValues.value(i));
+        actualSet->append(data.values.value(i));
+        categories.append(data.labels[i]);
+    }
     
-    double totalIncome = m_user->getTotalIncome(startDate, endDate);
-    double totalExpense = m_user->getTotalExpense(startDate, endDate);
-    double balance = totalIncome - totalExpense;
+    QBarSeries* series = new QBarSeries();
+    series->append(budgetSet);
+    series->append(actualSet);
+    chart->addSeries(series);
+    
+    QBarCategoryAxis* axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+    
+    QValueAxis* axisY = new QValueAxis();
+    axisY->setTitleText("金额 (¥)");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
     
-    m_totalIncomeLabel->setText(QString("¥%1").arg(totalIncome, 0, 'f', 2));
-    m_totalExpenseLabel->setText(QString("¥%1").arg(totalExpense, 0, 'f', 2));
+    chart->legend()->setAlignment(Qt::AlignBottom);
+    
+    m_mainChartView->setChart(chart);
+}
+
+void StatisticsWidget::updateRollingSpendChart(const ReportService::ChartData& data) {
+    QChart* chart = new QChart();
+    chart->setTitle("滚动支出");
+    
+    QStringList categories;
+    for (const auto& label : data.labels) {
+        categories.append(label);
+    }
+    QBarCategoryAxis* axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    axisX->setTitleText("日期");
+    chart->addAxis(axisX, Qt::AlignBottom);
+    
+    QValueAxis* axisY = new QValueAxis();
+    axisY->setTitleText("金额 (¥)");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    
+    // 每个窗口长度一条折线
+    QVector<QColor> colors = {QColor("#E74C3C"), QColor("#F5A623"), QColor("#4A90E2")};
+    for (int i = 0; i < data.seriesValues.size(); ++i) {
+        QLineSeries* series = new QLineSeries();
+        series->setName(data.seriesNames.value(i));
+        series->setColor(colors[i % colors.size()]);
+        const auto& values = data.seriesValues[i];
+        for (int day = 0; day < values.size(); ++day) {
+            series->append(day, values[day]);
+        }
+        chart->addSeries(series);
+        series->attachAxis(axisX);
+        series->attachAxis(axisY);
+    }
+    
+    chart->legend()->setAlignment(Qt::AlignBottom);
+    
+    m_mainChartView->setChart(chart);
+}
+
+void StatisticsWidget::updatePeriodComparisonChart(const ReportService::ChartData& data) {
+    QChart* chart = new QChart();
+    chart->setTitle("分类环比、同比");
+    
+    // 每个分类一组柱：本期、上月同期、去年同期
+    QVector<QColor> colors = {QColor("#E74C3C"), QColor("#F5A623"), QColor("#95A5A6")};
+    QBarSeries* series = new QBarSeries();
+    for (int i = 0; i < data.seriesValues.size(); ++i) {
+        QBarSet* set = new QBarSet(data.seriesNames.value(i));
+        set->setColor(colors[i % colors.size()]);
+        for (double value : data.seriesValues[i]) {
+            set->append(value);
+        }
+        series->append(set);
+    }
+    chart->addSeries(series);
+    
+    // 分类标签附带环比、同比变化额
+    QStringList categories;
+    for (int i = 0; i < data.labels.size(); ++i) {
+        double current = data.seriesValues.value(0).value(i);
+        double monthDelta = current - data.seriesValues.value(1).value(i);
+        double yearDelta = current - data.seriesValues.value(2).value(i);
+        categories.append(QString("%1\n环比%2 同比%3")
+                          .arg(data.labels[i])
+                          .arg(monthDelta, 0, 'f', 0)
+                          .arg(yearDelta, 0, 'f', 0));
+    }
+    QBarCategoryAxis* axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+    
+    QValueAxis* axisY = new QValueAxis();
+    axisY->setTitleText("金额 (¥)");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+    
+    chart->legend()->setAlignment(Qt::AlignBottom);
+    
+    m_mainChartView->setChart(chart);
+}
+
+void StatisticsWidget::updateTopDestinationsChart(const ReportService::ChartData& data) {
+    QChart* chart = new QChart();
+    chart->setTitle("支出去向排行");
+    
+    // 金额从大到小，每个去向一根柱
+    QBarSet* amountSet = new QBarSet("支出");
+    amountSet->setColor(QColor("#E74C3C"));
+    QStringList categories;
+    for (int i = 0; i < data.labels.size(); ++i) {
+        amountSet->append(data.values.value(i));
+        categories.append(data.labels[i]);
+    }
+    
+    QBarSeries* series = new QBarSeries();
+    series->append(amountSet);
+    chart->addSeries(series);
+    
+    QBarCategoryAxis* axisX = new QBarCategoryAxis();
+    axisX->append(categories);
+    chart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+    
+    QValueAxis* axisY = new QValueAxis();
+    axisY->setTitleText("金额 (¥)");
+    chart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+    
+    chart->legend()->setVisible(false);
+    
+    m_mainChartView->setChart(chart);
+}
+
+void StatisticsWidget::updateSummaryLabels(const ReportService::StatisticsData& data) {
+    double balance = data.balance;
+    
+    m_totalIncomeLabel->setText(QString("¥%1").arg(data.totalIncome, 0, 'f', 2));
+    m_totalExpenseLabel->setText(QString("¥%1").arg(data.totalExpense, 0, 'f', 2));
     
     if (balance >= 0) {
         m_balanceLabel->setText(QString("¥%1").arg(balance, 0, 'f', 2));
@@ -290,14 +449,8 @@ void StatisticsWidget::updateSummaryLabels() {
         m_balanceLabel->setStyleSheet("QLabel { color: #E74C3C; font-weight: bold; }");
     }
     
-    // 计算日均支出
-    int days = startDate.daysTo(endDate) + 1;
-    double avgDailyExpense = days > 0 ? totalExpense / days : 0;
-    m_avgDailyExpenseLabel->setText(QString("¥%1").arg(avgDailyExpense, 0, 'f', 2));
-    
-    // 获取交易笔数
-    auto records = m_user->getRecordsByDateRange(startDate, endDate);
-    m_transactionCountLabel->setText(QString::number(records.size()));
+    m_avgDailyExpenseLabel->setText(QString("¥%1").arg(data.avgDailyExpense, 0, 'f', 2));
+    m_transactionCountLabel->setText(QString::number(data.transactionCount));
 }
 
 void StatisticsWidget::onTimeRangeChanged(int index) {
@@ -329,20 +482,17 @@ void StatisticsWidget::onTimeRangeChanged(int index) {
             break;
     }
     
-    updateCharts();
-    updateSummaryLabels();
+    refreshData();
 }
 
 void StatisticsWidget::onStartDateChanged(const QDate& date) {
     Q_UNUSED(date)
-    updateCharts();
-    updateSummaryLabels();
+    refreshData();
 }
 
 void StatisticsWidget::onEndDateChanged(const QDate& date) {
     Q_UNUSED(date)
-    updateCharts();
-    updateSummaryLabels();
+    refreshData();
 }
 
 void StatisticsWidget::onChartTypeChanged(int index) {
@@ -350,32 +500,48 @@ void StatisticsWidget::onChartTypeChanged(int index) {
     updateCharts();
 }
 
+void StatisticsWidget::onTimeDimensionChanged(int index) {
+    Q_UNUSED(index)
+    updateCharts();
+}
+
 void StatisticsWidget::onExportChart() {
     // 导出图表功能
     QMessageBox::information(this, "导出功能", "图表导出功能开发中...");
 }
 
 void StatisticsWidget::onGenerateReport() {
-    QDate startDate = m_startDateEdit->date();
-    QDate endDate = m_endDateEdit->date();
-    
-    ReportService::StatisticsData data = m_reportService->generateStatistics(startDate, endDate);
-    onReportGenerated(data);
-    
-    // 同时生成图表数据
-    ReportService::ChartData chartData = m_reportService->generateChartData(
-        ReportService::ReportType::IncomeExpense, 
-        ReportService::TimeDimension::Monthly, 
-        startDate, endDate);
-    onChartDataReady(chartData);
+    // 结果由 onReportGenerated / onChartDataReady 异步接收
+    requestStatistics();
+    requestChart();
 }
 
 void StatisticsWidget::onReportGenerated(const ReportService::StatisticsData& data) {
     m_currentStatistics = data;
-    updateSummaryLabels();
+    updateSummaryLabels(data);
 }
 
 void StatisticsWidget::onChartDataReady(const ReportService::ChartData& data) {
-    // 使用图表数据更新显示
-    Q_UNUSED(data)
+    switch (data.type) {
+        case ReportService::ReportType::CategoryAnalysis:
+            updateCategoryChart(data);
+            break;
+        case ReportService::ReportType::TrendAnalysis:
+            updateTrendChart(data);
+            break;
+        case ReportService::ReportType::BudgetPerformance:
+            updateBudgetChart(data);
+            break;
+        case ReportService::ReportType::RollingSpend:
+            updateRollingSpendChart(data);
+            break;
+        case ReportService::ReportType::PeriodComparison:
+            updatePeriodComparisonChart(data);
+            break;
+        case ReportService::ReportType::TopDestinations:
+            updateTopDestinationsChart(data);
+            break;
+        default:
+            updateIncomeExpenseChart(data);
+    }
 }
\ No newline at end of file
@@ -18,7 +18,9 @@ class StatisticsWidget : public QWidget {
     Q_OBJECT
 
 public:
-    explicit StatisticsWidget(std::shared_ptr<User> user, QWidget *parent = nullptr);
+    // reportService 为空时自行创建
+    StatisticsWidget(std::shared_ptr<User> user, std::shared_ptr<ReportService> reportService,
+                     QWidget *parent = nullptr);
     ~StatisticsWidget();
 
 public slots:
@@ -30,6 +32,7 @@ private slots:
     void onStartDateChanged(const QDate& date);
     void onEndDateChanged(const QDate& date);
     void onChartTypeChanged(int index);
+    void onTimeDimensionChanged(int index);
     void onExportChart();
     void onGenerateReport();
     void onReportGenerated(const ReportService::StatisticsData& data);
@@ -40,16 +43,24 @@ private:
     void createLayout();
     void createConnections();
     void initializeCharts();
-    void updateIncomeExpenseChart();
-    void updateCategoryChart();
-    void updateTrendChart();
-    void updateSummaryLabels();
+    // 向报告服务提交异步请求，新请求会取代尚未完成的旧请求
+    void requestStatistics();
+    void requestChart();
+    void updateIncomeExpenseChart(const ReportService::ChartData& data);
+    void updateCategoryChart(const ReportService::ChartData& data);
+    void updateTrendChart(const ReportService::ChartData& data);
+    void updateBudgetChart(const ReportService::ChartData& data);
+    void updateRollingSpendChart(const ReportService::ChartData& data);
+    void updatePeriodComparisonChart(const ReportService::ChartData& data);
+    void updateTopDestinationsChart(const ReportService::ChartData& data);
+    void updateSummaryLabels(const ReportService::StatisticsData& data);
     
     // UI组件
     QComboBox* m_timeRangeCombo;
     QDateEdit* m_startDateEdit;
     QDateEdit* m_endDateEdit;
     QComboBox* m_chartTypeCombo;
+    QComboBox* m_timeDimensionCombo;
     QPushButton* m_exportButton;
     QPushButton* m_generateButton;
     
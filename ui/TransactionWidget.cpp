@@ -14,6 +14,7 @@
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QDoubleSpinBox>
+#include <algorithm>
 #include <QFormLayout>
 #include <QDateTime>
 
@@ -133,6 +134,12 @@ void TransactionWidget::createConnections() {
     connect(m_categoryFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &TransactionWidget::onCategoryFilterChanged);
     connect(m_searchEdit, &QLineEdit::textChanged, this, &TransactionWidget::searchTransactions);
+
+    // 模型内容变化时刷新统计
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &TransactionWidget::updateSummary);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &TransactionWidget::updateSummary);
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &TransactionWidget::updateSummary);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &TransactionWidget::updateSummary);
 }
 
 void TransactionWidget::loadCategories() {
@@ -170,21 +177,9 @@ void TransactionWidget::onAddTransaction() {
     if (dlg.exec() == QDialog::Accepted) {
         auto record = dlg.getRecord();
         if (record) {
-            // 添加到用户数据和模型
+            // 添加到用户数据；模型和预算已用金额通过变更事件同步
             m_user->addRecord(record);
-            if (m_model) {
-                m_model->addRecord(record);
-            }
-
-            // 如果是支出且有匹配的预算，更新预算已用金额
-            if (record->isExpense()) {
-                auto b = m_user->getBudget(record->getCategoryId());
-                if (b) {
-                    b->addExpense(record->getAmount());
-                }
-            }
 
-            updateSummary();
             emit recordsChanged();
         }
     }
@@ -193,40 +188,14 @@ void TransactionWidget::onAddTransaction() {
 void TransactionWidget::onEditTransaction() {
     if (!m_selectedRecord) return;
 
-    // capture old values to adjust budgets after edit
-    Record::Type oldType = m_selectedRecord->getType();
-    double oldAmount = m_selectedRecord->getAmount();
-    QString oldCategory = m_selectedRecord->getCategoryId();
+    // capture old values; User adjusts budgets from the before/after pair
+    Record before = *m_selectedRecord;
 
     AddTransactionDialog dlg(m_user, m_selectedRecord, this);
     if (dlg.exec() == QDialog::Accepted) {
-        // record modified in-place
-        if (m_model) {
-            m_model->updateRecord(m_selectedRecord);
-        }
-
-        // adjust budgets according to changes
-        Record::Type newType = m_selectedRecord->getType();
-        double newAmount = m_selectedRecord->getAmount();
-        QString newCategory = m_selectedRecord->getCategoryId();
-
-        // if old was expense, remove its effect
-        if (oldType == Record::Type::Expense) {
-            auto oldBudget = m_user->getBudget(oldCategory);
-            if (oldBudget) {
-                oldBudget->removeExpense(oldAmount);
-            }
-        }
-
-        // if new is expense, add its effect
-        if (newType == Record::Type::Expense) {
-            auto newBudget = m_user->getBudget(newCategory);
-            if (newBudget) {
-                newBudget->addExpense(newAmount);
-            }
-        }
+        // record modified in-place; publish the change with its previous values
+        m_user->updateRecord(m_selectedRecord, before);
 
-        updateSummary();
         emit recordsChanged();
     }
 }
@@ -236,24 +205,13 @@ void TransactionWidget::onDeleteTransaction() {
 
     QString id = m_selectedRecord->getId();
 
-    // 如果是支出且有匹配的预算，减少预算已用金额
-    if (m_selectedRecord->isExpense()) {
-        auto b = m_user->getBudget(m_selectedRecord->getCategoryId());
-        if (b) {
-            b->removeExpense(m_selectedRecord->getAmount());
-        }
-    }
-
-    // 从用户中移除（标记为删除）
+    // 从用户中移除，模型通过变更事件同步
     m_user->removeRecord(id);
-    // 从模型中移除
-    if (m_model) m_model->removeRecord(id);
 
     m_selectedRecord = nullptr;
     m_editButton->setEnabled(false);
     m_deleteButton->setEnabled(false);
 
-    updateSummary();
     emit recordsChanged();
 }
 
@@ -288,7 +246,44 @@ void TransactionWidget::onCategoryFilterChanged(int index) {
 TransactionModel::TransactionModel(std::shared_ptr<User> user, QObject *parent)
     : QAbstractTableModel(parent)
     , m_user(user)
+    , m_subscriptionId(-1)
 {
+    if (m_user) {
+        m_subscriptionId = m_user->subscribe([this](const User::ChangeEvent& event) {
+            onUserChanged(event);
+        });
+    }
+}
+
+TransactionModel::~TransactionModel() {
+    if (m_user) {
+        m_user->unsubscribe(m_subscriptionId);
+    }
+}
+
+void TransactionModel::onUserChanged(const User::ChangeEvent& event) {
+    switch (event.kind) {
+        case User::ChangeEvent::Kind::RecordsAdded:
+            addRecords(event.records);
+            break;
+        case User::ChangeEvent::Kind::RecordModified:
+            for (const auto& record : event.records) {
+                updateRecord(record);
+            }
+            break;
+        case User::ChangeEvent::Kind::RecordsRemoved:
+            removeRecords(event.records);
+            break;
+        case User::ChangeEvent::Kind::CategoryModified:
+        case User::ChangeEvent::Kind::CategoryRemoved:
+            // 分类名称显示在表格中
+            if (!m_records.isEmpty()) {
+                emit dataChanged(index(0, CategoryColumn), index(m_records.size() - 1, CategoryColumn));
+            }
+            break;
+        default:
+            break;
+    }
 }
 
 int TransactionModel::rowCount(const QModelIndex &parent) const {
@@ -369,8 +364,12 @@ bool TransactionModel::removeRows(int row, int count, const QModelIndex &parent)
         return false;
     
     beginRemoveRows(parent, row, row + count - 1);
-    for (int i = 0; i < count; ++i)
+    for (int i = 0; i < count; ++i) {
+        if (m_records[row])
+            m_rowById.remove(m_records[row]->getId());
         m_records.removeAt(row);
+    }
+    reindexFrom(row);
     endRemoveRows();
     
     return true;
@@ -379,44 +378,90 @@ bool TransactionModel::removeRows(int row, int count, const QModelIndex &parent)
 void TransactionModel::setRecords(const QVector<std::shared_ptr<Record>>& records) {
     beginResetModel();
     m_records = records;
+    m_rowById.clear();
+    reindexFrom(0);
     endResetModel();
 }
 
 void TransactionModel::addRecord(std::shared_ptr<Record> record) {
     beginInsertRows(QModelIndex(), m_records.size(), m_records.size());
     m_records.append(record);
+    reindexFrom(m_records.size() - 1);
+    endInsertRows();
+}
+
+void TransactionModel::addRecords(const QVector<std::shared_ptr<Record>>& records) {
+    if (records.isEmpty()) return;
+    int first = m_records.size();
+    beginInsertRows(QModelIndex(), first, first + records.size() - 1);
+    m_records.append(records);
+    reindexFrom(first);
     endInsertRows();
 }
 
 void TransactionModel::removeRecord(const QString& recordId) {
-    for (int i = 0; i < m_records.size(); ++i) {
-        if (m_records[i] && m_records[i]->getId() == recordId) {
-            beginRemoveRows(QModelIndex(), i, i);
-            m_records.removeAt(i);
-            endRemoveRows();
-            return;
+    int row = indexOfRecord(recordId);
+    if (row < 0) return;
+    beginRemoveRows(QModelIndex(), row, row);
+    m_records.removeAt(row);
+    m_rowById.remove(recordId);
+    reindexFrom(row);
+    endRemoveRows();
+}
+
+void TransactionModel::removeRecords(const QVector<std::shared_ptr<Record>>& records) {
+    QVector<int> rows;
+    rows.reserve(records.size());
+    for (const auto& record : records) {
+        int row = record ? indexOfRecord(record->getId()) : -1;
+        if (row >= 0) {
+            rows.append(row);
+        }
+    }
+    if (rows.isEmpty()) return;
+    
+    // 从后往前删除，前面各行的行号保持不变
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    int end = rows.size();
+    while (end > 0) {
+        int begin = end - 1;
+        while (begin > 0 && rows[begin - 1] == rows[begin] - 1) {
+            --begin;
+        }
+        int first = rows[begin];
+        int last = rows[end - 1];
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row) {
+            if (m_records[row]) {
+                m_rowById.remove(m_records[row]->getId());
+            }
         }
+        m_records.erase(m_records.begin() + first, m_records.begin() + last + 1);
+        endRemoveRows();
+        end = begin;
     }
+    reindexFrom(rows.first());
 }
 
 void TransactionModel::updateRecord(std::shared_ptr<Record> record) {
     if (!record) return;
-    for (int i = 0; i < m_records.size(); ++i) {
-        if (m_records[i] && m_records[i]->getId() == record->getId()) {
-            m_records[i] = record;
-            QModelIndex topLeft = index(i, 0);
-            QModelIndex bottomRight = index(i, ColumnCount - 1);
-            emit dataChanged(topLeft, bottomRight);
-            return;
-        }
-    }
+    int row = indexOfRecord(record->getId());
+    if (row < 0) return;
+    m_records[row] = record;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
 }
 
 int TransactionModel::indexOfRecord(const QString& recordId) const {
-    for (int i = 0; i < m_records.size(); ++i) {
-        if (m_records[i] && m_records[i]->getId() == recordId) return i;
+    return m_rowById.value(recordId, -1);
+}
+
+void TransactionModel::reindexFrom(int row) {
+    for (int i = row; i < m_records.size(); ++i) {
+        if (m_records[i]) {
+            m_rowById.insert(m_records[i]->getId(), i);
+        }
     }
-    return -1;
 }
 
 std::shared_ptr<Record> TransactionModel::getRecord(int row) const {
@@ -428,6 +473,7 @@ std::shared_ptr<Record> TransactionModel::getRecord(int row) const {
 void TransactionModel::clear() {
     beginResetModel();
     m_records.clear();
+    m_rowById.clear();
     endResetModel();
 }
 
@@ -505,7 +551,7 @@ std::shared_ptr<Record> AddTransactionDialog::getRecord() const {
 
 void AddTransactionDialog::onAccepted() {
     // 构造 Record
-    if (!m_record) m_record = std::make_shared<Record>();
+    if (!m_record) m_record = Record::create();
 
     // 设置日期时间
     QDate date = m_dateEdit->date();
@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QDate>
+#include <QHash>
 #include <QDialog>
 #include <memory>
 #include "../models/User.h"
@@ -126,6 +127,7 @@ class TransactionModel : public QAbstractTableModel {
 
 public:
     explicit TransactionModel(std::shared_ptr<User> user, QObject *parent = nullptr);
+    ~TransactionModel();
     
     // 重载的虚函数
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -137,7 +139,10 @@ public:
     // 自定义函数
     void setRecords(const QVector<std::shared_ptr<Record>>& records);
     void addRecord(std::shared_ptr<Record> record);
+    void addRecords(const QVector<std::shared_ptr<Record>>& records);
     void removeRecord(const QString& recordId);
+    // 批量删除：一次遍历删除所有行，连续的行合并为一次行删除通知
+    void removeRecords(const QVector<std::shared_ptr<Record>>& records);
     void updateRecord(std::shared_ptr<Record> record);
     int indexOfRecord(const QString& recordId) const;
     std::shared_ptr<Record> getRecord(int row) const;
@@ -154,8 +159,14 @@ public:
     };
 
 private:
+    void onUserChanged(const User::ChangeEvent& event);
+    // 重建 row 及之后各行的ID索引
+    void reindexFrom(int row);
+
     QVector<std::shared_ptr<Record>> m_records;
+    QHash<QString, int> m_rowById;   // 记录ID -> 行号
     std::shared_ptr<User> m_user;
+    int m_subscriptionId;
 };
 
 #endif // TRANSACTIONWIDGET_H
\ No newline at end of file